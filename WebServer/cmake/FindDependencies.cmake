@@ -34,3 +34,11 @@ find_package(PkgConfig REQUIRED)
 
 # 使用PkgConfig查找yaml-cpp
 pkg_check_modules(YAML_CPP REQUIRED yaml-cpp)
+
+# 响应压缩
+find_package(ZLIB REQUIRED)
+
+# 测试依赖
+if(BUILD_TESTING)
+    find_package(GTest REQUIRED)
+endif()
@@ -4,6 +4,9 @@ set(CMAKE_CXX_STANDARD_REQUIRED ON)
 
 # 启用测试
 option(BUILD_TESTING "Build the testing tree.")
+if(BUILD_TESTING)
+  enable_testing()
+endif()
 
 # 设置构建类型
 if(NOT CMAKE_BUILD_TYPE)
@@ -0,0 +1,108 @@
+// response_compressor.h
+#pragma once
+
+#include "http_response.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Accept-Encoding 中客户端可接受的内容编码，按位组合
+enum ContentCoding : unsigned {
+    CODING_BR = 1,
+    CODING_GZIP = 2,
+    CODING_DEFLATE = 4
+};
+
+// 解析 Accept-Encoding，返回可接受编码的位掩码；q=0 表示明确拒绝，* 匹配没有单独列出的编码
+unsigned parseAcceptEncoding(const std::string& header);
+
+// 即时压缩参数，对应 server_config.yaml 中的 compression_* 配置
+struct CompressionOptions {
+    bool enabled = false;
+    int level = 6;                                   // zlib 压缩级别 1-9
+    std::size_t minLength = 1024;                    // 响应体小于该长度时不压缩
+    std::size_t maxLength = 8 * 1024 * 1024;         // 静态文件超过该大小时不压缩
+    std::size_t inlineLength = 128 * 1024;           // 不超过该大小的静态文件在请求线程上压缩，更大的交给后台线程
+    std::size_t cacheSize = 16 * 1024 * 1024;        // 静态文件压缩结果缓存的字节数，0 表示不缓存
+    std::vector<std::string> mimeTypes = {
+        "text/html", "text/css", "text/plain", "text/xml", "application/javascript",
+        "application/json", "application/xml", "image/svg+xml"
+    };
+};
+
+// 静态文件的压缩结果
+struct CompressedFile {
+    std::shared_ptr<const std::string> data;  // 为空时发送原文件
+    bool pending = false;  // 正在后台压缩：此时的原文件响应只是过渡，不应放入内容缓存
+};
+
+// 用 zlib 对响应体做 gzip / deflate 压缩
+// 动态响应直接压缩内存中的响应体；静态文件的压缩结果按 ETag 缓存，同一版本的文件只压缩一次，
+// 压缩后不更小的也记录下来，之后直接发送原文件；大文件第一次请求时交给后台线程压缩，不阻塞事件循环
+// 缓存容量按字节计，LRU 淘汰；ETag 随文件内容变化，旧版本的结果不会再被命中，自然被淘汰
+class ResponseCompressor {
+public:
+    explicit ResponseCompressor(const CompressionOptions& options);
+    ~ResponseCompressor();
+
+    ResponseCompressor(const ResponseCompressor&) = delete;
+    ResponseCompressor& operator=(const ResponseCompressor&) = delete;
+
+    bool enabled() const;
+    // 类型在配置列表中、长度不小于 minLength 时响应随 Accept-Encoding 变化
+    bool compressible(const std::string& contentType, std::size_t length) const;
+    // 在 accepted 中选择即时压缩使用的编码 (优先 gzip)，不压缩时返回 0
+    unsigned negotiate(unsigned accepted) const;
+    static const char* codingName(unsigned coding);
+
+    // 压缩动态响应：可压缩时总是加上 Vary: Accept-Encoding，客户端接受时替换响应体并设置 Content-Encoding
+    // 流式、文件、已编码以及 Cache-Control: no-transform 的响应保持不变
+    void compress(HttpResponse& response, unsigned accepted) const;
+    // 读出整个文件并压缩，结果以 etag 和编码为键缓存；超过 inlineLength 的文件放入后台队列并返回 pending
+    // 超过 maxLength、读取或压缩失败、压缩后不更小时 data 为空
+    CompressedFile compressFile(const std::string& etag, const std::shared_ptr<const FileDescriptor>& file,
+                                std::size_t size, unsigned coding);
+    std::size_t cacheBytes() const;
+
+private:
+    // 后台队列的上限，队列满时新的大文件先按原文件发送，下次请求再排队
+    static constexpr std::size_t MAX_PENDING = 64;
+
+    struct Node {
+        std::shared_ptr<const std::string> data;  // 为空表示压缩后不更小
+        std::list<std::string>::iterator lru;
+    };
+
+    struct Job {
+        std::string key;
+        std::shared_ptr<const FileDescriptor> file;
+        std::size_t size;
+        unsigned coding;
+    };
+
+    CompressionOptions options_;
+    mutable std::mutex mutex_;
+    std::list<std::string> lru_;  // 最近使用的在前
+    std::unordered_map<std::string, Node> entries_;
+    std::size_t bytes_ = 0;
+    std::deque<Job> jobs_;
+    std::unordered_set<std::string> pending_;  // 排队或正在压缩的键
+    std::condition_variable jobReady_;
+    bool stop_ = false;
+    std::thread worker_;
+
+    void run();
+    // 读取并压缩文件后放入缓存，返回值同 CompressedFile::data
+    std::shared_ptr<const std::string> compressAndInsert(const std::string& key, int fd, std::size_t size,
+                                                         unsigned coding);
+    bool deflateData(const char* data, std::size_t size, unsigned coding, std::string& out) const;
+    void insert(const std::string& key, std::shared_ptr<const std::string> data);
+};
@@ -0,0 +1,271 @@
+// response_compressor.cpp
+#include "response_compressor.h"
+#include "http_types.h"
+#include "logger.h"
+#include <errno.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <string_view>
+
+static constexpr struct {
+    const char* name;
+    unsigned coding;
+} CODINGS[] = {{"br", CODING_BR}, {"gzip", CODING_GZIP}, {"deflate", CODING_DEFLATE}};
+
+unsigned parseAcceptEncoding(const std::string& header) {
+    unsigned accepted = 0;
+    unsigned listed = 0;
+    bool wildcard = false;
+    std::size_t pos = 0;
+    while (pos < header.size()) {
+        std::size_t comma = header.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = header.size();
+        }
+        std::string_view item(header.data() + pos, comma - pos);
+        pos = comma + 1;
+
+        std::size_t semicolon = item.find(';');
+        std::string_view coding = trim_ows(item.substr(0, semicolon));
+        bool refused = false;
+        if (semicolon != std::string_view::npos) {
+            std::string_view params = item.substr(semicolon + 1);
+            std::size_t q = params.find("q=");
+            if (q == std::string_view::npos) {
+                q = params.find("Q=");
+            }
+            if (q != std::string_view::npos) {
+                std::string_view value = params.substr(q + 2, params.find_first_of(" \t;", q + 2) - q - 2);
+                refused = !value.empty() && value.front() == '0' && value.find_first_not_of("0.") == std::string_view::npos;
+            }
+        }
+
+        if (coding == "*") {
+            wildcard = !refused;
+            continue;
+        }
+        for (const auto& known : CODINGS) {
+            if (equals_ignore_case(coding, known.name)) {
+                listed |= known.coding;
+                if (!refused) {
+                    accepted |= known.coding;
+                }
+            }
+        }
+    }
+    if (wildcard) {
+        accepted |= (CODING_BR | CODING_GZIP | CODING_DEFLATE) & ~listed;
+    }
+    return accepted;
+}
+
+ResponseCompressor::ResponseCompressor(const CompressionOptions& options) : options_(options) {
+    options_.level = std::clamp(options_.level, 1, 9);
+    if (options_.enabled && options_.inlineLength < options_.maxLength) {
+        worker_ = std::thread([this] { run(); });
+    }
+}
+
+ResponseCompressor::~ResponseCompressor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    jobReady_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void ResponseCompressor::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobReady_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            if (stop_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        compressAndInsert(job.key, job.file->get(), job.size, job.coding);
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.erase(job.key);
+    }
+}
+
+bool ResponseCompressor::enabled() const {
+    return options_.enabled;
+}
+
+bool ResponseCompressor::compressible(const std::string& contentType, std::size_t length) const {
+    if (!options_.enabled || length < options_.minLength) {
+        return false;
+    }
+    // 忽略 charset 等参数
+    std::string_view type = trim_ows(std::string_view(contentType).substr(0, contentType.find(';')));
+    return std::any_of(options_.mimeTypes.begin(), options_.mimeTypes.end(),
+                       [&](const std::string& mimeType) { return equals_ignore_case(type, mimeType); });
+}
+
+unsigned ResponseCompressor::negotiate(unsigned accepted) const {
+    if (!options_.enabled) {
+        return 0;
+    }
+    if (accepted & CODING_GZIP) {
+        return CODING_GZIP;
+    }
+    return accepted & CODING_DEFLATE;
+}
+
+const char* ResponseCompressor::codingName(unsigned coding) {
+    for (const auto& known : CODINGS) {
+        if (known.coding == coding) {
+            return known.name;
+        }
+    }
+    return "identity";
+}
+
+void ResponseCompressor::compress(HttpResponse& response, unsigned accepted) const {
+    HttpStatusCode code = response.getStatusCode();
+    if (response.isStreaming() || response.hasBodyFile() || response.isSerialized() ||
+        static_cast<int>(code) < 200 || code == HttpStatusCode::NO_CONTENT ||
+        code == HttpStatusCode::PARTIAL_CONTENT || code == HttpStatusCode::NOT_MODIFIED ||
+        response.hasHeader("Content-Encoding") ||
+        response.getHeader("Cache-Control").find("no-transform") != std::string::npos) {
+        return;
+    }
+    const std::string& body = response.getBody();
+    if (!compressible(response.getHeader("Content-Type"), body.size())) {
+        return;
+    }
+
+    std::string vary = response.getHeader("Vary");
+    if (vary.empty()) {
+        response.setHeader("Vary", "Accept-Encoding");
+    } else if (vary != "*" && vary.find("Accept-Encoding") == std::string::npos) {
+        response.setHeader("Vary", vary + ", Accept-Encoding");
+    }
+
+    unsigned coding = negotiate(accepted);
+    std::string compressed;
+    if (!coding || !deflateData(body.data(), body.size(), coding, compressed) || compressed.size() >= body.size()) {
+        return;
+    }
+    response.setBody(std::move(compressed));
+    response.setHeader("Content-Encoding", codingName(coding));
+    // 压缩后的字节与原表示不同，强校验器降为弱校验器
+    std::string etag = response.getHeader("ETag");
+    if (!etag.empty() && etag.compare(0, 2, "W/") != 0) {
+        response.setHeader("ETag", "W/" + etag);
+    }
+}
+
+CompressedFile ResponseCompressor::compressFile(const std::string& etag,
+                                               const std::shared_ptr<const FileDescriptor>& file, std::size_t size,
+                                               unsigned coding) {
+    if (!options_.enabled || size > options_.maxLength) {
+        return {};
+    }
+    std::string key = etag + codingName(coding);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return {it->second.data, false};
+        }
+        // 大文件交给后台线程，这次先发送原文件
+        if (size > options_.inlineLength && worker_.joinable()) {
+            if (pending_.count(key) || jobs_.size() >= MAX_PENDING) {
+                return {nullptr, true};
+            }
+            pending_.insert(key);
+            jobs_.push_back({key, file, size, coding});
+            jobReady_.notify_one();
+            return {nullptr, true};
+        }
+    }
+    // 在锁外读取和压缩，同一文件被并发请求时可能重复压缩一次
+    return {compressAndInsert(key, file->get(), size, coding), false};
+}
+
+std::shared_ptr<const std::string> ResponseCompressor::compressAndInsert(const std::string& key, int fd,
+                                                                         std::size_t size, unsigned coding) {
+    std::string content(size, '\0');
+    std::size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, content.data() + done, size - done, static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return nullptr;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    std::string compressed;
+    if (!deflateData(content.data(), content.size(), coding, compressed)) {
+        return nullptr;
+    }
+    // 压缩后不更小时只记录结论，之后直接发送原文件
+    std::shared_ptr<const std::string> data;
+    if (compressed.size() < size) {
+        data = std::make_shared<const std::string>(std::move(compressed));
+    }
+    insert(key, data);
+    return data;
+}
+
+std::size_t ResponseCompressor::cacheBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+bool ResponseCompressor::deflateData(const char* data, std::size_t size, unsigned coding, std::string& out) const {
+    if (size > UINT_MAX || (coding != CODING_GZIP && coding != CODING_DEFLATE)) {
+        return false;
+    }
+    z_stream stream = {};
+    // windowBits 加 16 输出 gzip 格式；HTTP 的 deflate 指 zlib 格式 (RFC 9110 8.4.1.2)
+    int windowBits = coding == CODING_GZIP ? 15 + 16 : 15;
+    if (deflateInit2(&stream, options_.level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        LOG_ERROR("deflateInit2 failed");
+        return false;
+    }
+    // deflateBound 保证一次 Z_FINISH 即可完成
+    out.resize(deflateBound(&stream, static_cast<uLong>(size)));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    int ret = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return ret == Z_STREAM_END;
+}
+
+void ResponseCompressor::insert(const std::string& key, std::shared_ptr<const std::string> data) {
+    std::size_t size = key.size() + (data ? data->size() : 0);
+    if (size > options_.cacheSize) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.count(key)) {
+        return;
+    }
+    while (bytes_ + size > options_.cacheSize) {
+        auto victim = entries_.find(lru_.back());
+        bytes_ -= victim->first.size() + (victim->second.data ? victim->second.data->size() : 0);
+        entries_.erase(victim);
+        lru_.pop_back();
+    }
+    lru_.push_front(key);
+    entries_.emplace(key, Node{std::move(data), lru_.begin()});
+    bytes_ += size;
+}
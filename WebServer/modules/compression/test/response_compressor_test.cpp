@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "response_compressor.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// 解压 gzip 或 zlib 格式 (windowBits 加 32 自动识别)
+static std::string inflateData(const std::string& data) {
+    z_stream stream = {};
+    EXPECT_EQ(inflateInit2(&stream, 15 + 32), Z_OK);
+    std::string out(64 * 1024, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+    return out;
+}
+
+static std::string makeText() {
+    std::string text;
+    for (int i = 0; i < 200; i++) {
+        text += "line " + std::to_string(i) + " of a compressible body\n";
+    }
+    return text;
+}
+
+static HttpResponse makeResponse(const std::string& type, const std::string& body) {
+    auto response = HttpResponse::newHttpResponse();
+    response.setStatusCode(HttpStatusCode::OK).setHeader("Content-Type", type).setBody(body);
+    return response;
+}
+
+static CompressionOptions enabledOptions() {
+    CompressionOptions options;
+    options.enabled = true;
+    return options;
+}
+
+TEST(ResponseCompressorTest, ParsesAcceptEncoding) {
+    EXPECT_EQ(parseAcceptEncoding(""), 0u);
+    EXPECT_EQ(parseAcceptEncoding("gzip, deflate, br"), unsigned(CODING_BR | CODING_GZIP | CODING_DEFLATE));
+    EXPECT_EQ(parseAcceptEncoding("GZip;q=0.5, br;q=0"), unsigned(CODING_GZIP));
+    EXPECT_EQ(parseAcceptEncoding("*;q=0.1, gzip;q=0.000"), unsigned(CODING_BR | CODING_DEFLATE));
+    EXPECT_EQ(parseAcceptEncoding("*;q=0"), 0u);
+    EXPECT_EQ(parseAcceptEncoding("identity, compress"), 0u);
+}
+
+TEST(ResponseCompressorTest, CompressesAcceptedResponses) {
+    ResponseCompressor compressor(enabledOptions());
+    std::string text = makeText();
+
+    auto gzip = makeResponse("text/html; charset=utf-8", text);
+    gzip.setHeader("ETag", "\"v1\"");
+    compressor.compress(gzip, CODING_GZIP | CODING_DEFLATE);
+    EXPECT_EQ(gzip.getHeader("Content-Encoding"), "gzip");
+    EXPECT_EQ(gzip.getHeader("Vary"), "Accept-Encoding");
+    EXPECT_EQ(gzip.getHeader("ETag"), "W/\"v1\"");
+    EXPECT_LT(gzip.getBody().size(), text.size());
+    EXPECT_EQ(static_cast<unsigned char>(gzip.getBody()[0]), 0x1f);  // gzip 魔数
+    EXPECT_EQ(inflateData(gzip.getBody()), text);
+
+    auto deflate = makeResponse("application/json", text);
+    deflate.setHeader("Vary", "Origin");
+    compressor.compress(deflate, CODING_DEFLATE | CODING_BR);
+    EXPECT_EQ(deflate.getHeader("Content-Encoding"), "deflate");
+    EXPECT_EQ(deflate.getHeader("Vary"), "Origin, Accept-Encoding");
+    EXPECT_EQ(inflateData(deflate.getBody()), text);
+}
+
+TEST(ResponseCompressorTest, LeavesIneligibleResponsesUnchanged) {
+    ResponseCompressor compressor(enabledOptions());
+    std::string text = makeText();
+
+    // 可压缩但客户端不接受：只加 Vary
+    auto identity = makeResponse("text/plain", text);
+    compressor.compress(identity, CODING_BR);
+    EXPECT_EQ(identity.getBody(), text);
+    EXPECT_FALSE(identity.hasHeader("Content-Encoding"));
+    EXPECT_EQ(identity.getHeader("Vary"), "Accept-Encoding");
+
+    auto small = makeResponse("text/plain", "short");
+    auto image = makeResponse("image/png", text);
+    auto encoded = makeResponse("text/plain", text);
+    encoded.setHeader("Content-Encoding", "br");
+    auto noTransform = makeResponse("text/plain", text);
+    noTransform.setHeader("Cache-Control", "no-transform");
+    auto notModified = makeResponse("text/plain", text);
+    notModified.setStatusCode(HttpStatusCode::NOT_MODIFIED);
+    for (auto* response : {&small, &image, &encoded, &noTransform, &notModified}) {
+        std::string before = response->getBody();
+        compressor.compress(*response, CODING_GZIP);
+        EXPECT_EQ(response->getBody(), before);
+        EXPECT_FALSE(response->hasHeader("Vary"));
+    }
+
+    ResponseCompressor disabled{CompressionOptions()};
+    auto response = makeResponse("text/plain", text);
+    disabled.compress(response, CODING_GZIP);
+    EXPECT_EQ(response.getBody(), text);
+    EXPECT_EQ(disabled.negotiate(CODING_GZIP), 0u);
+}
+
+// 写入匿名临时文件，返回持有 fd 的 FileDescriptor
+static std::shared_ptr<const FileDescriptor> makeFile(const std::string& content) {
+    char path[] = "/tmp/response_compressor_test_XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    unlink(path);
+    EXPECT_EQ(write(fd, content.data(), content.size()), static_cast<ssize_t>(content.size()));
+    return std::make_shared<const FileDescriptor>(fd);
+}
+
+TEST(ResponseCompressorTest, CachesCompressedFilesByEtag) {
+    std::string text = makeText();
+    auto file = makeFile(text);
+    CompressionOptions options = enabledOptions();
+    options.maxLength = text.size();
+    ResponseCompressor compressor(options);
+    auto first = compressor.compressFile("\"a\"", file, text.size(), CODING_GZIP);
+    ASSERT_NE(first.data, nullptr);
+    EXPECT_FALSE(first.pending);
+    EXPECT_EQ(inflateData(*first.data), text);
+    EXPECT_GT(compressor.cacheBytes(), first.data->size());
+
+    // 同一 ETag 和编码直接返回缓存的结果，不同编码分别缓存
+    EXPECT_EQ(compressor.compressFile("\"a\"", file, text.size(), CODING_GZIP).data, first.data);
+    auto deflate = compressor.compressFile("\"a\"", file, text.size(), CODING_DEFLATE).data;
+    ASSERT_NE(deflate, nullptr);
+    EXPECT_NE(deflate, first.data);
+    EXPECT_EQ(inflateData(*deflate), text);
+
+    // 超过 maxLength 时不压缩
+    EXPECT_EQ(compressor.compressFile("\"b\"", file, text.size() + 1, CODING_GZIP).data, nullptr);
+}
+
+TEST(ResponseCompressorTest, KeepsOnlySmallerOutputs) {
+    // 伪随机字节几乎不可压缩，gzip 输出比原文件大
+    std::string noise(4096, '\0');
+    uint32_t state = 12345;
+    for (char& c : noise) {
+        state = state * 1103515245 + 12345;
+        c = static_cast<char>(state >> 24);
+    }
+    auto file = makeFile(noise);
+    ResponseCompressor compressor(enabledOptions());
+    EXPECT_EQ(compressor.compressFile("\"n\"", file, noise.size(), CODING_GZIP).data, nullptr);
+    // 结论被缓存，只占键的大小
+    EXPECT_GT(compressor.cacheBytes(), 0u);
+    EXPECT_LT(compressor.cacheBytes(), 64u);
+    EXPECT_EQ(compressor.compressFile("\"n\"", file, noise.size(), CODING_GZIP).data, nullptr);
+}
+
+TEST(ResponseCompressorTest, CompressesLargeFilesInBackground) {
+    std::string text = makeText();
+    auto file = makeFile(text);
+    CompressionOptions options = enabledOptions();
+    options.inlineLength = text.size() - 1;
+    ResponseCompressor compressor(options);
+    auto first = compressor.compressFile("\"a\"", file, text.size(), CODING_GZIP);
+    EXPECT_EQ(first.data, nullptr);
+    EXPECT_TRUE(first.pending);
+
+    CompressedFile result;
+    for (int i = 0; i < 200 && !result.data; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        result = compressor.compressFile("\"a\"", file, text.size(), CODING_GZIP);
+    }
+    ASSERT_NE(result.data, nullptr);
+    EXPECT_FALSE(result.pending);
+    EXPECT_EQ(inflateData(*result.data), text);
+}
+
+TEST(ResponseCompressorTest, EvictsLeastRecentlyUsedOutputs) {
+    std::string text = makeText();
+    auto file = makeFile(text);
+    CompressionOptions options = enabledOptions();
+    auto sample = ResponseCompressor(options).compressFile("\"0\"", file, text.size(), CODING_GZIP).data;
+    ASSERT_NE(sample, nullptr);
+    options.cacheSize = 2 * (sample->size() + 8);
+    ResponseCompressor compressor(options);
+    auto a = compressor.compressFile("\"0\"", file, text.size(), CODING_GZIP).data;
+    auto b = compressor.compressFile("\"1\"", file, text.size(), CODING_GZIP).data;
+    EXPECT_EQ(compressor.compressFile("\"0\"", file, text.size(), CODING_GZIP).data, a);
+    compressor.compressFile("\"2\"", file, text.size(), CODING_GZIP);
+    EXPECT_LE(compressor.cacheBytes(), options.cacheSize);
+    EXPECT_EQ(compressor.compressFile("\"0\"", file, text.size(), CODING_GZIP).data, a);
+    EXPECT_NE(compressor.compressFile("\"1\"", file, text.size(), CODING_GZIP).data, b);
+}
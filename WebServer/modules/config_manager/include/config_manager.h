@@ -3,6 +3,7 @@
 
 #include <yaml-cpp/yaml.h>
 #include <string>
+#include <vector>
 #include "logger.h"
 
 class ConfigManager {
@@ -16,6 +17,34 @@ public:
     int getPort() const;
     int getThreadPoolSize() const;
     std::string getPublicDirectory() const;
+    std::string getServerMode() const;
+    int getEventLoopThreads() const;
+    std::string getIoBackend() const;
+    std::size_t getBodySpillThreshold() const;
+    std::string getBodySpillDirectory() const;
+    std::size_t getOutputHighWatermark() const;
+    std::size_t getOutputLowWatermark() const;
+    // 连接超时 (秒)，0 表示不限制
+    int getKeepAliveTimeout() const;
+    int getHeaderTimeout() const;
+    int getBodyTimeout() const;
+    int getWriteTimeout() const;
+    std::size_t getKeepAliveRequests() const;
+    std::size_t getPipelineDepth() const;
+    std::size_t getOpenFileCacheMax() const;
+    int getOpenFileCacheValid() const;
+    std::size_t getContentCacheSize() const;
+    std::size_t getContentCacheMaxObject() const;
+    unsigned getContentCacheMinUses() const;
+    bool getStaticFileWatch() const;
+    bool getStaticPrecompressed() const;
+    bool getCompression() const;
+    int getCompressionLevel() const;
+    std::size_t getCompressionMinLength() const;
+    std::size_t getCompressionMaxLength() const;
+    std::size_t getCompressionInlineLength() const;
+    std::size_t getCompressionCacheSize() const;
+    std::vector<std::string> getCompressionTypes() const;
     LogLevel getLogLevel() const;
     std::string getLogFile() const;
 
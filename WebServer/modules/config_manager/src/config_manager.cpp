@@ -48,6 +48,224 @@ std::string ConfigManager::getPublicDirectory() const {
     }
 }
 
+std::string ConfigManager::getServerMode() const {
+    try {
+        return config["server"]["mode"].as<std::string>("reactor");
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting string value for key server mode: " + std::string(e.what()));
+    }
+}
+
+int ConfigManager::getEventLoopThreads() const {
+    try {
+        return config["server"]["event_loop_threads"].as<int>(0);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server event_loop_threads: " + std::string(e.what()));
+    }
+}
+
+std::string ConfigManager::getIoBackend() const {
+    try {
+        return config["server"]["io_backend"].as<std::string>("epoll");
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting string value for key server io_backend: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getBodySpillThreshold() const {
+    try {
+        return config["server"]["body_spill_threshold"].as<std::size_t>(1024 * 1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server body_spill_threshold: " + std::string(e.what()));
+    }
+}
+
+std::string ConfigManager::getBodySpillDirectory() const {
+    try {
+        return config["server"]["body_spill_directory"].as<std::string>("/tmp");
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting string value for key server body_spill_directory: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getOutputHighWatermark() const {
+    try {
+        return config["server"]["output_high_watermark"].as<std::size_t>(1024 * 1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server output_high_watermark: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getOutputLowWatermark() const {
+    try {
+        return config["server"]["output_low_watermark"].as<std::size_t>(256 * 1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server output_low_watermark: " + std::string(e.what()));
+    }
+}
+
+int ConfigManager::getKeepAliveTimeout() const {
+    try {
+        return config["server"]["keepalive_timeout"].as<int>(60);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server keepalive_timeout: " + std::string(e.what()));
+    }
+}
+
+int ConfigManager::getHeaderTimeout() const {
+    try {
+        return config["server"]["header_timeout"].as<int>(20);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server header_timeout: " + std::string(e.what()));
+    }
+}
+
+int ConfigManager::getBodyTimeout() const {
+    try {
+        return config["server"]["body_timeout"].as<int>(60);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server body_timeout: " + std::string(e.what()));
+    }
+}
+
+int ConfigManager::getWriteTimeout() const {
+    try {
+        return config["server"]["write_timeout"].as<int>(60);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server write_timeout: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getKeepAliveRequests() const {
+    try {
+        return config["server"]["keepalive_requests"].as<std::size_t>(1000);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server keepalive_requests: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getPipelineDepth() const {
+    try {
+        return config["server"]["pipeline_depth"].as<std::size_t>(1);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server pipeline_depth: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getOpenFileCacheMax() const {
+    try {
+        return config["server"]["open_file_cache_max"].as<std::size_t>(1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server open_file_cache_max: " + std::string(e.what()));
+    }
+}
+
+int ConfigManager::getOpenFileCacheValid() const {
+    try {
+        return config["server"]["open_file_cache_valid"].as<int>(60);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server open_file_cache_valid: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getContentCacheSize() const {
+    try {
+        return config["server"]["content_cache_size"].as<std::size_t>(64 * 1024 * 1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server content_cache_size: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getContentCacheMaxObject() const {
+    try {
+        return config["server"]["content_cache_max_object"].as<std::size_t>(256 * 1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server content_cache_max_object: " + std::string(e.what()));
+    }
+}
+
+unsigned ConfigManager::getContentCacheMinUses() const {
+    try {
+        return config["server"]["content_cache_min_uses"].as<unsigned>(2);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server content_cache_min_uses: " + std::string(e.what()));
+    }
+}
+
+bool ConfigManager::getStaticFileWatch() const {
+    try {
+        return config["server"]["static_file_watch"].as<bool>(true);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting bool value for key server static_file_watch: " + std::string(e.what()));
+    }
+}
+
+bool ConfigManager::getStaticPrecompressed() const {
+    try {
+        return config["server"]["static_precompressed"].as<bool>(true);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting bool value for key server static_precompressed: " + std::string(e.what()));
+    }
+}
+
+bool ConfigManager::getCompression() const {
+    try {
+        return config["server"]["compression"].as<bool>(true);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting bool value for key server compression: " + std::string(e.what()));
+    }
+}
+
+int ConfigManager::getCompressionLevel() const {
+    try {
+        return config["server"]["compression_level"].as<int>(6);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server compression_level: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getCompressionMinLength() const {
+    try {
+        return config["server"]["compression_min_length"].as<std::size_t>(1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server compression_min_length: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getCompressionMaxLength() const {
+    try {
+        return config["server"]["compression_max_length"].as<std::size_t>(8 * 1024 * 1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server compression_max_length: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getCompressionInlineLength() const {
+    try {
+        return config["server"]["compression_inline_length"].as<std::size_t>(128 * 1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server compression_inline_length: " + std::string(e.what()));
+    }
+}
+
+std::size_t ConfigManager::getCompressionCacheSize() const {
+    try {
+        return config["server"]["compression_cache_size"].as<std::size_t>(16 * 1024 * 1024);
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting int value for key server compression_cache_size: " + std::string(e.what()));
+    }
+}
+
+std::vector<std::string> ConfigManager::getCompressionTypes() const {
+    try {
+        // 未配置时返回空列表，由调用方使用默认类型
+        const auto& node = config["server"]["compression_types"];
+        return node ? node.as<std::vector<std::string>>() : std::vector<std::string>();
+    } catch (const YAML::Exception &e) {
+        throw std::runtime_error("Error getting list value for key server compression_types: " + std::string(e.what()));
+    }
+}
+
 LogLevel ConfigManager::getLogLevel() const {
     try {
         std::string level = config["logger"]["level"].as<std::string>();
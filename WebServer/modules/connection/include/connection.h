@@ -0,0 +1,148 @@
+#pragma once
+
+#include "http_parser.h"
+#include "http_response.h"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class ConnectionState {
+    CONNECTED,  // 正常读写
+    CLOSING,    // 等待在途发送完成后关闭
+    CLOSED      // 已从事件循环移除，等待最后一个引用释放
+};
+
+// 连接当前在等什么，决定适用哪一个超时
+enum class TimeoutPhase {
+    HEADER,     // 请求头：从收到请求的第一个字节 (新连接从建立时) 算起，中途的读取不推后
+    BODY,       // 请求体：两次读取之间的间隔
+    IDLE,       // keep-alive 空闲：上一个响应发完之后
+    WRITE       // 响应：两次成功发送之间的间隔
+};
+
+// 单个客户端连接：持有 fd、请求解析器、输入缓冲区和输出缓冲链
+// 连接归属于一个事件循环；Reactor + 线程池模式下同一连接的读写任务通过 mutex() 串行化
+class Connection {
+public:
+    static constexpr std::size_t INPUT_BUFFER_SIZE = 8192; // 8KB
+    static constexpr std::size_t STREAM_CHUNK_SIZE = 16 * 1024; // 流式响应每次生成的数据量
+    static constexpr std::size_t MAX_IOVECS = 64;  // 一次 sendmsg 最多聚集的块数 (IOV_MAX 为 1024)
+
+    explicit Connection(int fd);
+    ~Connection();
+
+    // 禁用拷贝
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    int fd() const;
+    ConnectionState state() const;
+    void setState(ConnectionState state);
+    bool isConnected() const;
+
+    HttpParser &parser();
+    std::vector<char> &inputBuffer();
+
+    // 输出缓冲链，按追加顺序发送；块在被完全消费前地址保持不变
+    void appendOutput(std::string data);
+    // 共享的只读块（如内容缓存中预先序列化的响应），不拷贝
+    void appendOutput(std::shared_ptr<const std::string> data);
+    // 共享块中的一段，用于在预先序列化的响应中插入连接相关的头部
+    void appendOutput(std::shared_ptr<const std::string> data, std::size_t offset, std::size_t length);
+    // 流式响应体在链中占一个位置，前面的输出发完后才调用 producer 生成数据，chunked 时按块加帧
+    void appendProducer(BodyProducer producer, bool chunked);
+    // 文件响应体在链中占一个位置，轮到它时用 sendfile 发送
+    void appendFile(FileBody file);
+    // 队首是流式响应体时先生成一段数据放到它前面；producer 抛出异常时返回 false，连接应当关闭
+    bool prepareOutput();
+    bool hasOutput() const;
+    // 以下几个只在 prepareOutput() 之后、hasOutput() 为真时有效
+    std::size_t outputSize() const;     // 队首块中尚未发送的字节数
+    int outputFileFd() const;           // 队首为文件块时返回文件 fd，否则返回 -1
+    off_t outputFileOffset() const;     // 文件块中下一个待发送字节的偏移
+    // 队首不是文件块时，从队首起把连续的内存块（响应头、响应体、预先序列化的响应……）聚集到 iov，
+    // 遇到文件块、流式占位或满 max 个时停止；返回块数，more 表示之后还有输出，发送时可以带 MSG_MORE
+    std::size_t gatherOutput(iovec *iov, std::size_t max, bool &more) const;
+    // 可以跨越多个块
+    void consumeOutput(std::size_t bytes);
+    std::size_t pendingBytes() const;   // 整条链上已生成但尚未发送的字节数
+    void clearOutput();
+
+    // io_uring 后端：同一连接同时只有一个 send 在途
+    bool isSending() const;
+    void setSending(bool sending);
+    // 待发送字节超过高水位后暂停读取和解析，已解析的请求留在解析器中，降到低水位以下再恢复
+    bool isReadPaused() const;
+    void setReadPaused(bool paused);
+    // io_uring 后端：multishot recv 是否仍然挂着
+    bool isReceiving() const;
+    void setReceiving(bool receiving);
+    // epoll 后端：socket 写满后登记了 EPOLLOUT，可写时从断点继续，输出链发完后恢复只监听 EPOLLIN
+    bool isWaitingWritable() const;
+    void setWaitingWritable(bool waiting);
+    // io_uring 后端：把 gatherOutput 的结果放进连接自己的 msghdr，在途的 sendmsg 完成前一直有效
+    const msghdr *gatherMessage(bool &more);
+
+    // 超时：读写路径按当前阶段推后 deadline (可在工作线程中调用)；事件循环为每个连接挂一个定时器，
+    // 到期时若 deadline 已被推后就按剩余时间重新挂上，因此大多数读写不必碰时间轮
+    using Clock = std::chrono::steady_clock;
+    TimeoutPhase timeoutPhase() const;
+    Clock::time_point deadline() const;
+    void setDeadline(TimeoutPhase phase, Clock::time_point deadline);
+    // 已挂定时器的 id 和到期时间，只在所属事件循环线程中修改；没有定时器时 id 为 0、到期时间为 max
+    uint64_t timerId() const;
+    Clock::time_point timerExpires() const;
+    void setTimer(uint64_t id, Clock::time_point expires);
+
+    // 持久连接：已处理的请求数；连接不再保持时，最后一个响应之后的请求不再处理，输出发完后关闭
+    std::size_t countRequest();
+    bool isKeepAlive() const;
+    void setKeepAlive(bool keepAlive);
+
+    std::mutex &mutex();
+
+private:
+    struct OutputItem {
+        std::string data;
+        BodyProducer producer;  // 非空时为流式响应体的占位
+        bool chunked = false;
+        FileBody file;          // file.file 非空时为文件块，data 不使用
+        std::shared_ptr<const std::string> shared;  // 非空时为共享块，data 不使用
+        std::string_view view;  // 共享块中要发送的部分
+    };
+
+    static std::size_t itemSize(const OutputItem &item);
+
+    int fd_;
+    std::atomic<ConnectionState> state_;
+    HttpParser parser_;
+    std::vector<char> input_buffer_;
+    std::deque<OutputItem> output_;
+    std::size_t output_offset_;
+    std::size_t output_bytes_;
+    bool sending_;
+    bool waiting_writable_;
+    bool read_paused_;
+    bool receiving_;
+    std::size_t requests_;
+    bool keep_alive_;
+    std::atomic<TimeoutPhase> timeout_phase_;
+    std::atomic<Clock::time_point> deadline_;
+    uint64_t timer_id_;
+    std::atomic<Clock::time_point> timer_expires_;
+    std::array<iovec, MAX_IOVECS> send_iov_;
+    msghdr send_msg_;
+    std::mutex mutex_;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "connection.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// 以 fd 为下标的连接槽位表，查找 O(1)，不做哈希也没有全局锁
+// 两级分块数组按需分配，容量上限为 RLIMIT_NOFILE；表本身从不扩容，不同 fd 的槽位可在不同线程并发访问
+// 同一个 fd 的槽位只应由其所属事件循环线程读写
+class ConnectionTable {
+public:
+    ConnectionTable();
+    explicit ConnectionTable(std::size_t capacity);
+    ~ConnectionTable();
+
+    // 禁用拷贝
+    ConnectionTable(const ConnectionTable&) = delete;
+    ConnectionTable& operator=(const ConnectionTable&) = delete;
+
+    // fd 超出容量时返回 false
+    bool insert(std::shared_ptr<Connection> connection);
+    std::shared_ptr<Connection> find(int fd) const;
+    std::shared_ptr<Connection> erase(int fd);
+
+    std::size_t capacity() const;
+
+private:
+    static constexpr std::size_t CHUNK_SIZE = 4096;
+    using Chunk = std::array<std::shared_ptr<Connection>, CHUNK_SIZE>;
+
+    std::size_t capacity_;
+    std::size_t chunk_count_;
+    std::unique_ptr<std::atomic<Chunk *>[]> chunks_;
+
+    Chunk *getChunk(int fd) const;
+    Chunk *getOrCreateChunk(int fd);
+};
@@ -0,0 +1,273 @@
+#include "connection.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+
+Connection::Connection(int fd)
+    : fd_(fd),
+      state_(ConnectionState::CONNECTED),
+      input_buffer_(INPUT_BUFFER_SIZE),
+      output_offset_(0),
+      output_bytes_(0),
+      sending_(false),
+      waiting_writable_(false),
+      read_paused_(false),
+      receiving_(false),
+      requests_(0),
+      keep_alive_(true),
+      timeout_phase_(TimeoutPhase::HEADER),
+      deadline_(Clock::time_point::max()),
+      timer_id_(0),
+      timer_expires_(Clock::time_point::max()),
+      send_iov_(),
+      send_msg_() {}
+
+Connection::~Connection() {
+    close(fd_);
+}
+
+int Connection::fd() const {
+    return fd_;
+}
+
+ConnectionState Connection::state() const {
+    return state_.load(std::memory_order_acquire);
+}
+
+void Connection::setState(ConnectionState state) {
+    state_.store(state, std::memory_order_release);
+}
+
+bool Connection::isConnected() const {
+    return state() == ConnectionState::CONNECTED;
+}
+
+HttpParser &Connection::parser() {
+    return parser_;
+}
+
+std::vector<char> &Connection::inputBuffer() {
+    return input_buffer_;
+}
+
+void Connection::appendOutput(std::string data) {
+    if (data.empty()) {
+        return;
+    }
+    output_bytes_ += data.size();
+    output_.push_back({std::move(data), nullptr, false, {}, nullptr, {}});
+}
+
+void Connection::appendOutput(std::shared_ptr<const std::string> data) {
+    if (!data) {
+        return;
+    }
+    std::size_t length = data->size();
+    appendOutput(std::move(data), 0, length);
+}
+
+void Connection::appendOutput(std::shared_ptr<const std::string> data, std::size_t offset, std::size_t length) {
+    if (!data || length == 0) {
+        return;
+    }
+    std::string_view view(data->data() + offset, length);
+    output_bytes_ += length;
+    output_.push_back({std::string(), nullptr, false, {}, std::move(data), view});
+}
+
+void Connection::appendProducer(BodyProducer producer, bool chunked) {
+    output_.push_back({std::string(), std::move(producer), chunked, {}, nullptr, {}});
+}
+
+void Connection::appendFile(FileBody file) {
+    if (file.length == 0) {
+        return;
+    }
+    output_bytes_ += file.length;
+    output_.push_back({std::string(), nullptr, false, std::move(file), nullptr, {}});
+}
+
+bool Connection::prepareOutput() {
+    while (!output_.empty() && output_.front().producer) {
+        OutputItem &item = output_.front();
+        std::string chunk;
+        bool more = true;
+        try {
+            while (more && chunk.size() < STREAM_CHUNK_SIZE) {
+                more = item.producer(chunk);
+            }
+        } catch (...) {
+            return false;
+        }
+
+        // chunk-size CRLF data CRLF，最后一块之后追加 0 CRLF CRLF
+        std::string framed;
+        bool chunked = item.chunked;
+        if (chunked && !chunk.empty()) {
+            char size_line[32];
+            int n = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", chunk.size());
+            framed.reserve(n + chunk.size() + 7);
+            framed.append(size_line, n).append(chunk).append("\r\n");
+        } else {
+            framed = std::move(chunk);
+        }
+        if (!more) {
+            if (chunked) {
+                framed.append("0\r\n\r\n");
+            }
+            output_.pop_front();
+        }
+        if (!framed.empty()) {
+            output_bytes_ += framed.size();
+            output_.push_front({std::move(framed), nullptr, false, {}, nullptr, {}});
+        }
+    }
+    return true;
+}
+
+bool Connection::hasOutput() const {
+    return !output_.empty();
+}
+
+std::size_t Connection::outputSize() const {
+    return itemSize(output_.front()) - output_offset_;
+}
+
+int Connection::outputFileFd() const {
+    const FileBody &file = output_.front().file;
+    return file.file ? file.file->get() : -1;
+}
+
+off_t Connection::outputFileOffset() const {
+    return output_.front().file.offset + static_cast<off_t>(output_offset_);
+}
+
+std::size_t Connection::gatherOutput(iovec *iov, std::size_t max, bool &more) const {
+    std::size_t count = 0;
+    std::size_t offset = output_offset_;
+    for (const OutputItem &item : output_) {
+        if (count == max || item.file.file || item.producer) {
+            break;
+        }
+        std::string_view data = item.shared ? item.view : std::string_view(item.data);
+        iov[count].iov_base = const_cast<char *>(data.data()) + offset;
+        iov[count].iov_len = data.size() - offset;
+        count++;
+        offset = 0;
+    }
+    more = count < output_.size();
+    return count;
+}
+
+void Connection::consumeOutput(std::size_t bytes) {
+    output_bytes_ -= bytes;
+    while (bytes > 0) {
+        std::size_t remaining = itemSize(output_.front()) - output_offset_;
+        if (bytes < remaining) {
+            output_offset_ += bytes;
+            return;
+        }
+        bytes -= remaining;
+        output_.pop_front();
+        output_offset_ = 0;
+    }
+}
+
+std::size_t Connection::pendingBytes() const {
+    return output_bytes_;
+}
+
+void Connection::clearOutput() {
+    output_.clear();
+    output_offset_ = 0;
+    output_bytes_ = 0;
+}
+
+bool Connection::isSending() const {
+    return sending_;
+}
+
+void Connection::setSending(bool sending) {
+    sending_ = sending;
+}
+
+bool Connection::isWaitingWritable() const {
+    return waiting_writable_;
+}
+
+void Connection::setWaitingWritable(bool waiting) {
+    waiting_writable_ = waiting;
+}
+
+bool Connection::isReadPaused() const {
+    return read_paused_;
+}
+
+void Connection::setReadPaused(bool paused) {
+    read_paused_ = paused;
+}
+
+bool Connection::isReceiving() const {
+    return receiving_;
+}
+
+void Connection::setReceiving(bool receiving) {
+    receiving_ = receiving;
+}
+
+TimeoutPhase Connection::timeoutPhase() const {
+    return timeout_phase_;
+}
+
+Connection::Clock::time_point Connection::deadline() const {
+    return deadline_;
+}
+
+void Connection::setDeadline(TimeoutPhase phase, Clock::time_point deadline) {
+    timeout_phase_ = phase;
+    deadline_ = deadline;
+}
+
+uint64_t Connection::timerId() const {
+    return timer_id_;
+}
+
+Connection::Clock::time_point Connection::timerExpires() const {
+    return timer_expires_;
+}
+
+void Connection::setTimer(uint64_t id, Clock::time_point expires) {
+    timer_id_ = id;
+    timer_expires_ = expires;
+}
+
+const msghdr *Connection::gatherMessage(bool &more) {
+    send_msg_ = {};
+    send_msg_.msg_iov = send_iov_.data();
+    send_msg_.msg_iovlen = gatherOutput(send_iov_.data(), send_iov_.size(), more);
+    return &send_msg_;
+}
+
+std::size_t Connection::countRequest() {
+    return ++requests_;
+}
+
+bool Connection::isKeepAlive() const {
+    return keep_alive_;
+}
+
+void Connection::setKeepAlive(bool keepAlive) {
+    keep_alive_ = keepAlive;
+}
+
+std::mutex &Connection::mutex() {
+    return mutex_;
+}
+
+std::size_t Connection::itemSize(const OutputItem &item) {
+    if (item.file.file) {
+        return item.file.length;
+    }
+    return item.shared ? item.view.size() : item.data.size();
+}
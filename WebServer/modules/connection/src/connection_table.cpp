@@ -0,0 +1,87 @@
+#include "connection_table.h"
+#include "logger.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+
+static std::size_t getFdLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) < 0 || limit.rlim_cur == RLIM_INFINITY) {
+        return 1 << 20;
+    }
+    return std::max<std::size_t>(limit.rlim_cur, 1024);
+}
+
+ConnectionTable::ConnectionTable()
+    : ConnectionTable(getFdLimit()) {}
+
+ConnectionTable::ConnectionTable(std::size_t capacity)
+    : capacity_(capacity),
+      chunk_count_((capacity + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      chunks_(std::make_unique<std::atomic<Chunk *>[]>(chunk_count_)) {
+    for (std::size_t i = 0; i < chunk_count_; i++) {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ConnectionTable::~ConnectionTable() {
+    for (std::size_t i = 0; i < chunk_count_; i++) {
+        delete chunks_[i].load(std::memory_order_relaxed);
+    }
+}
+
+bool ConnectionTable::insert(std::shared_ptr<Connection> connection) {
+    int fd = connection->fd();
+    Chunk *chunk = getOrCreateChunk(fd);
+    if (!chunk) {
+        LOG_ERROR("fd %d exceeds connection table capacity %d", fd, capacity_);
+        return false;
+    }
+    (*chunk)[fd % CHUNK_SIZE] = std::move(connection);
+    return true;
+}
+
+std::shared_ptr<Connection> ConnectionTable::find(int fd) const {
+    Chunk *chunk = getChunk(fd);
+    if (!chunk) {
+        return nullptr;
+    }
+    return (*chunk)[fd % CHUNK_SIZE];
+}
+
+std::shared_ptr<Connection> ConnectionTable::erase(int fd) {
+    Chunk *chunk = getChunk(fd);
+    if (!chunk) {
+        return nullptr;
+    }
+    return std::move((*chunk)[fd % CHUNK_SIZE]);
+}
+
+std::size_t ConnectionTable::capacity() const {
+    return capacity_;
+}
+
+ConnectionTable::Chunk *ConnectionTable::getChunk(int fd) const {
+    if (fd < 0 || static_cast<std::size_t>(fd) >= capacity_) {
+        return nullptr;
+    }
+    return chunks_[fd / CHUNK_SIZE].load(std::memory_order_acquire);
+}
+
+ConnectionTable::Chunk *ConnectionTable::getOrCreateChunk(int fd) {
+    if (fd < 0 || static_cast<std::size_t>(fd) >= capacity_) {
+        return nullptr;
+    }
+    std::atomic<Chunk *> &slot = chunks_[fd / CHUNK_SIZE];
+    Chunk *chunk = slot.load(std::memory_order_acquire);
+    if (chunk) {
+        return chunk;
+    }
+    // 多个事件循环可能同时为同一块中的不同 fd 分配，CAS 失败的一方使用胜者的块
+    auto created = std::make_unique<Chunk>();
+    if (slot.compare_exchange_strong(chunk, created.get(), std::memory_order_acq_rel)) {
+        return created.release();
+    }
+    return chunk;
+}
@@ -0,0 +1,72 @@
+// content_cache.h
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// 热点静态内容缓存：按请求路径保存预先序列化好的完整响应，命中时不做任何文件系统调用
+// 容量按字节计，分成 SHARD_COUNT 个分片各自加锁并独立做 LRU 淘汰，工作线程之间几乎不争用
+// 准入策略：对象不超过 maxObjectSize，且在计数窗口内被请求满 minUses 次才放入，避免一次性请求冲掉热点
+class ContentCache {
+public:
+    using Matcher = std::function<bool(const std::string& key, const std::string& path)>;
+
+    ContentCache(std::size_t capacity, std::size_t maxObjectSize, unsigned minUses,
+                 std::chrono::steady_clock::duration valid);
+
+    bool enabled() const;
+    // 命中且未过期时返回共享的响应内容，否则返回空
+    std::shared_ptr<const std::string> find(const std::string& key);
+    // 记录一次未命中，返回大小为 size 的对象此时是否应当放入缓存
+    bool admit(const std::string& key, std::size_t size);
+    // 失效代数：加载前读取，插入时若期间发生过失效则放弃插入，避免把过时内容放回缓存
+    uint64_t generation() const;
+    // path 为响应内容对应文件的真实路径，用于按文件失效
+    void insert(const std::string& key, const std::string& path, std::shared_ptr<const std::string> response,
+                uint64_t generation);
+    void erase(const std::string& key);
+    // 删除 match 为真的条目并返回删除数
+    std::size_t invalidate(const Matcher& match);
+    void clear();
+    std::size_t bytes() const;   // 所有分片当前占用的字节数
+
+private:
+    static constexpr std::size_t SHARD_COUNT = 16;
+    // 每个分片最多记录的未准入对象数，超过后清空重新计数
+    static constexpr std::size_t USE_COUNTER_LIMIT = 4096;
+
+    struct Node {
+        std::shared_ptr<const std::string> response;
+        std::string path;
+        std::chrono::steady_clock::time_point expires;
+        std::list<std::string>::iterator lru;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<std::string> lru;  // 最近使用的在前
+        std::unordered_map<std::string, Node> entries;
+        std::unordered_map<std::string, unsigned> uses;  // 尚未准入对象的请求次数
+        std::size_t bytes = 0;
+    };
+
+    std::size_t shardCapacity_;
+    std::size_t maxObjectSize_;
+    unsigned minUses_;
+    std::chrono::steady_clock::duration valid_;
+    std::atomic<uint64_t> generation_{0};
+    std::array<Shard, SHARD_COUNT> shards_;
+
+    Shard& shardFor(const std::string& key);
+    static std::size_t entryBytes(const std::string& key, const std::string& response);
+    static void eraseLocked(Shard& shard, std::unordered_map<std::string, Node>::iterator it);
+};
@@ -0,0 +1,38 @@
+// file_watcher.h
+#pragma once
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 用 inotify 递归监视一个目录树，后台线程把一批事件涉及的路径交给回调
+// 回调收到的路径为绝对路径：文件本身，或整个被移走/删除/新建的目录，目录下的所有内容都应视为已改变
+// 事件队列溢出时回调收到根目录本身；inotify 不可用时构造函数抛出 std::runtime_error
+class FileWatcher {
+public:
+    using ChangeCallback = std::function<void(const std::vector<std::string>& paths)>;
+
+    FileWatcher(const std::string& root, ChangeCallback callback);
+    ~FileWatcher();
+
+    // 禁用拷贝
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+private:
+    std::string root_;
+    ChangeCallback callback_;
+    int inotify_fd_;
+    int wakeup_fd_;
+    std::unordered_map<int, std::string> watches_;  // wd -> 目录的绝对路径，只在监视线程中修改
+    std::thread thread_;
+
+    void run();
+    // 监视 dir 及其下所有子目录
+    void addWatches(const std::string& dir);
+    // 移除 dir 及其下所有子目录的监视（目录被移走后旧的 wd 会继续以旧路径报告事件）
+    void removeWatches(const std::string& dir);
+    void handleEvents(const char* buffer, std::size_t length, std::vector<std::string>& changes);
+};
@@ -0,0 +1,67 @@
+// open_file_cache.h
+#pragma once
+
+#include "http_types.h"
+#include "http_response.h"
+#include <sys/types.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 打开文件缓存（参考 nginx open_file_cache）：按请求路径缓存 fd、大小、修改时间、MIME 类型和安全检查结论
+// 404/403 这类查找结论同样缓存；条目数有上限，按 LRU 淘汰，超过有效期后重新打开
+class OpenFileCache {
+public:
+    // 同一文件的预压缩表示：同目录下的 .br / .gz 文件
+    struct Encoded {
+        std::string coding;  // Content-Encoding 的值
+        std::shared_ptr<const FileDescriptor> file;
+        std::size_t size = 0;
+        std::string etag;
+    };
+
+    struct Entry {
+        HttpStatusCode status = HttpStatusCode::OK;
+        std::shared_ptr<const FileDescriptor> file;
+        std::size_t size = 0;
+        time_t mtime = 0;
+        std::string etag;          // 带引号的强校验器
+        std::string lastModified;  // mtime 的 HTTP 日期格式
+        std::string mimeType;
+        std::string path;  // 解析后的真实路径；查找失败时为最后尝试的路径
+        std::vector<Encoded> encodings;  // 按优先级排列，br 在前
+    };
+    using Loader = std::function<Entry()>;
+    using Matcher = std::function<bool(const std::string& key, const Entry& entry)>;
+
+    OpenFileCache(std::size_t capacity, std::chrono::steady_clock::duration valid);
+
+    // 命中且未过期时直接返回，否则在锁外调用 loader 后放入缓存
+    // capacity 为 0 时不缓存；5xx 结果是暂时性错误（如 fd 耗尽），也不缓存
+    std::shared_ptr<const Entry> get(const std::string& key, const Loader& loader);
+    // 删除 match 为真的条目并返回删除数；失效之前开始、之后才完成的加载结果不会再放入缓存
+    std::size_t invalidate(const Matcher& match);
+    void clear();
+    std::size_t size() const;
+
+private:
+    struct Node {
+        std::shared_ptr<const Entry> entry;
+        std::chrono::steady_clock::time_point expires;
+        std::list<std::string>::iterator lru;
+    };
+
+    std::size_t capacity_;
+    std::chrono::steady_clock::duration valid_;
+    mutable std::mutex mutex_;
+    uint64_t generation_ = 0;     // 每次失效加一
+    std::list<std::string> lru_;  // 最近使用的在前
+    std::unordered_map<std::string, Node> entries_;
+};
@@ -4,21 +4,81 @@
 #include "http_types.h"
 #include "http_request.h"
 #include "http_response.h"
+#include "open_file_cache.h"
+#include "content_cache.h"
+#include "file_watcher.h"
+#include "response_compressor.h"
+#include <chrono>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 静态文件缓存参数，对应 server_config.yaml 中的同名配置
+struct StaticFileOptions {
+    std::size_t openFileCacheMax = 1024;                      // 打开文件缓存条目上限，0 表示不缓存
+    std::chrono::seconds openFileCacheValid{60};              // 两级缓存条目的有效期
+    std::size_t contentCacheSize = 64 * 1024 * 1024;          // 内容缓存字节数，0 表示不缓存
+    std::size_t contentCacheMaxObject = 256 * 1024;           // 单个文件超过该大小时不进入内容缓存
+    unsigned contentCacheMinUses = 2;                         // 被请求满该次数后才放入内容缓存
+    bool watchFiles = true;                                   // 用 inotify 在文件变化时立即失效缓存
+    bool precompressed = true;                                // 按 Accept-Encoding 发送同目录下的 .br / .gz 文件
+};
+
+enum class RangeResult {
+    NONE,           // 没有可用的 Range，返回完整内容
+    SATISFIABLE,
+    UNSATISFIABLE   // 416
+};
 
 class StaticFileController {
 public:
-    StaticFileController(const std::string& rootDir);
+    // 单次请求最多接受的区间数，超过时忽略 Range 返回完整内容，防止大量小区间放大开销
+    static constexpr std::size_t MAX_RANGES = 16;
+
+    // compressor 非空时对没有预压缩文件的可压缩类型即时压缩
+    explicit StaticFileController(const std::string& rootDir, const StaticFileOptions& options = {},
+                                  std::shared_ptr<ResponseCompressor> compressor = nullptr);
 
     HttpResponse serveFile(const HttpRequest& req, const std::unordered_map<std::string, std::string>& params);
 
 private:
     std::string rootDir_;
+    std::string canonicalRoot_;    // 构造时解析一次的根目录真实路径
+    bool precompressed_;
+    std::shared_ptr<ResponseCompressor> compressor_;
     std::unordered_map<std::string, std::string> mimeTypes_;
+    OpenFileCache openFileCache_;
+    ContentCache contentCache_;
+    std::unique_ptr<FileWatcher> watcher_;  // 最后声明，最先析构，回调不会访问已销毁的缓存
 
     void initMimeTypes();
     std::string getMimeType(const std::string& filename) const;
-    bool isPathSafe(const std::string& path) const;
+    // 缓存未命中时解析路径、做安全检查并打开文件
+    OpenFileCache::Entry openFile(const std::string& requestPath) const;
+    bool isPathSafe(const std::string& canonicalPath) const;
+    // 打开 resolved 旁边存在的预压缩文件，记录到 entry.encodings
+    void openEncodings(const std::string& resolved, OpenFileCache::Entry& entry) const;
+    // 在客户端接受的编码 (parseAcceptEncoding 的位掩码) 中选优先级最高的预压缩表示，没有时返回空
+    static const OpenFileCache::Encoded* selectEncoding(const OpenFileCache::Entry& entry, unsigned accepted);
+    // 请求路径按字面规范化后在根目录下对应的绝对路径，不解析符号链接
+    std::string lexicalPath(const std::string& requestPath) const;
+    // 监视线程回调：失效真实路径或字面路径等于某个变化路径或位于其下的缓存条目
+    void onFilesChanged(const std::vector<std::string>& paths);
+    static bool isAffected(const std::string& path, const std::unordered_set<std::string>& changed);
+    // 读出整个文件并和响应头一起序列化，用于放入内容缓存；读取失败时返回空
+    // encoded 非空时发送对应的预压缩表示
+    std::shared_ptr<const std::string> serializeFile(const OpenFileCache::Entry& entry,
+                                                     const OpenFileCache::Encoded* encoded) const;
+    // 按 If-None-Match / If-Modified-Since 判断客户端缓存的副本是否仍然有效
+    bool isNotModified(const HttpRequest& req, const OpenFileCache::Entry& entry,
+                       const OpenFileCache::Encoded* encoded) const;
+    // Range 请求：单区间返回 206 + Content-Range，多区间返回 multipart/byteranges；Range 被忽略时返回空
+    std::optional<HttpResponse> createRangeResponse(const HttpRequest& req, const OpenFileCache::Entry& entry) const;
+    HttpResponse createFileResponse(const OpenFileCache::Entry& entry,
+                                    HttpStatusCode code = HttpStatusCode::OK,
+                                    const OpenFileCache::Encoded* encoded = nullptr) const;
     HttpResponse createErrorResponse(HttpStatusCode code, const std::string& message) const;
 };
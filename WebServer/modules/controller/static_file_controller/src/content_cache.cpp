@@ -0,0 +1,145 @@
+// content_cache.cpp
+#include "content_cache.h"
+#include <iterator>
+
+ContentCache::ContentCache(std::size_t capacity, std::size_t maxObjectSize, unsigned minUses,
+                           std::chrono::steady_clock::duration valid)
+    : shardCapacity_(capacity / SHARD_COUNT),
+      maxObjectSize_(maxObjectSize),
+      minUses_(minUses),
+      valid_(valid) {}
+
+bool ContentCache::enabled() const {
+    return shardCapacity_ > 0 && maxObjectSize_ > 0;
+}
+
+std::shared_ptr<const std::string> ContentCache::find(const std::string& key) {
+    if (!enabled()) {
+        return nullptr;
+    }
+    Shard& shard = shardFor(key);
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        return nullptr;
+    }
+    if (now >= it->second.expires) {
+        eraseLocked(shard, it);
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+    return it->second.response;
+}
+
+bool ContentCache::admit(const std::string& key, std::size_t size) {
+    if (!enabled() || size > maxObjectSize_ || size > shardCapacity_) {
+        return false;
+    }
+    if (minUses_ <= 1) {
+        return true;
+    }
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.uses.find(key);
+    if (it == shard.uses.end()) {
+        if (shard.uses.size() >= USE_COUNTER_LIMIT) {
+            shard.uses.clear();
+        }
+        shard.uses.emplace(key, 1);
+        return false;
+    }
+    if (++it->second < minUses_) {
+        return false;
+    }
+    shard.uses.erase(it);
+    return true;
+}
+
+uint64_t ContentCache::generation() const {
+    return generation_.load();
+}
+
+void ContentCache::insert(const std::string& key, const std::string& path,
+                          std::shared_ptr<const std::string> response, uint64_t generation) {
+    std::size_t size = entryBytes(key, *response);
+    if (!enabled() || size > shardCapacity_) {
+        return;
+    }
+    Shard& shard = shardFor(key);
+    auto expires = std::chrono::steady_clock::now() + valid_;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // 失效先递增代数再逐个分片清理，这里在分片锁内检查，不会漏掉过时的插入
+    if (generation != generation_.load()) {
+        return;
+    }
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        eraseLocked(shard, it);
+    }
+    while (shard.bytes + size > shardCapacity_) {
+        eraseLocked(shard, shard.entries.find(shard.lru.back()));
+    }
+    shard.lru.push_front(key);
+    shard.entries.emplace(key, Node{std::move(response), path, expires, shard.lru.begin()});
+    shard.bytes += size;
+}
+
+void ContentCache::erase(const std::string& key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        eraseLocked(shard, it);
+    }
+}
+
+std::size_t ContentCache::invalidate(const Matcher& match) {
+    generation_++;
+    std::size_t erased = 0;
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+            auto next = std::next(it);
+            if (match(it->first, it->second.path)) {
+                eraseLocked(shard, it);
+                erased++;
+            }
+            it = next;
+        }
+    }
+    return erased;
+}
+
+void ContentCache::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.lru.clear();
+        shard.uses.clear();
+        shard.bytes = 0;
+    }
+}
+
+std::size_t ContentCache::bytes() const {
+    std::size_t total = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.bytes;
+    }
+    return total;
+}
+
+ContentCache::Shard& ContentCache::shardFor(const std::string& key) {
+    return shards_[std::hash<std::string>()(key) % SHARD_COUNT];
+}
+
+std::size_t ContentCache::entryBytes(const std::string& key, const std::string& response) {
+    return key.size() + response.size();
+}
+
+void ContentCache::eraseLocked(Shard& shard, std::unordered_map<std::string, Node>::iterator it) {
+    shard.bytes -= entryBytes(it->first, *it->second.response);
+    shard.lru.erase(it->second.lru);
+    shard.entries.erase(it);
+}
@@ -0,0 +1,137 @@
+// file_watcher.cpp
+#include "file_watcher.h"
+#include "logger.h"
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+// 内容变化、属性（权限）变化以及目录项的增删和移动
+static constexpr uint32_t WATCH_MASK = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE |
+                                       IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+FileWatcher::FileWatcher(const std::string& root, ChangeCallback callback)
+    : root_(root),
+      callback_(std::move(callback)),
+      inotify_fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+      wakeup_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (inotify_fd_ < 0 || wakeup_fd_ < 0) {
+        std::string error = strerror(errno);
+        if (inotify_fd_ >= 0) close(inotify_fd_);
+        if (wakeup_fd_ >= 0) close(wakeup_fd_);
+        throw std::runtime_error("inotify initialization failed: " + error);
+    }
+    addWatches(root_);
+    if (watches_.empty()) {
+        close(inotify_fd_);
+        close(wakeup_fd_);
+        throw std::runtime_error("inotify cannot watch " + root_);
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+FileWatcher::~FileWatcher() {
+    uint64_t one = 1;
+    ssize_t ret = write(wakeup_fd_, &one, sizeof(one));
+    (void)ret;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    close(inotify_fd_);
+    close(wakeup_fd_);
+}
+
+void FileWatcher::run() {
+    alignas(inotify_event) char buffer[64 * 1024];
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wakeup_fd_, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("inotify poll failed: %s", strerror(errno));
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+
+        // 一次读空队列，同一批事件只回调一次
+        std::vector<std::string> changes;
+        while (true) {
+            ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+            handleEvents(buffer, static_cast<std::size_t>(length), changes);
+        }
+        if (!changes.empty()) {
+            callback_(changes);
+        }
+    }
+}
+
+void FileWatcher::handleEvents(const char* buffer, std::size_t length, std::vector<std::string>& changes) {
+    for (std::size_t offset = 0; offset < length;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        offset += sizeof(inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            LOG_WARN("inotify queue overflow, invalidating everything under %s", root_.c_str());
+            changes.push_back(root_);
+            continue;
+        }
+        auto it = watches_.find(event->wd);
+        if (it == watches_.end()) {
+            continue;
+        }
+        if (event->mask & IN_IGNORED) {
+            watches_.erase(it);
+            continue;
+        }
+        // 没有名字的事件 (IN_DELETE_SELF 等) 针对被监视的目录本身
+        std::string path = event->len > 0 ? it->second + "/" + event->name : it->second;
+        changes.push_back(path);
+
+        if (event->mask & IN_ISDIR) {
+            if (event->mask & (IN_MOVED_FROM | IN_DELETE)) {
+                removeWatches(path);
+            } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                addWatches(path);
+            }
+        }
+    }
+}
+
+void FileWatcher::addWatches(const std::string& dir) {
+    int wd = inotify_add_watch(inotify_fd_, dir.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        LOG_WARN("inotify_add_watch %s failed: %s", dir.c_str(), strerror(errno));
+        return;
+    }
+    watches_[wd] = dir;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+            addWatches(entry.path().string());
+        }
+    }
+}
+
+void FileWatcher::removeWatches(const std::string& dir) {
+    for (auto it = watches_.begin(); it != watches_.end();) {
+        const std::string& path = it->second;
+        if (path == dir || (path.size() > dir.size() && path.compare(0, dir.size(), dir) == 0 && path[dir.size()] == '/')) {
+            inotify_rm_watch(inotify_fd_, it->first);
+            it = watches_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
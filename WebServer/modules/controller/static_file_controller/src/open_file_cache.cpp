@@ -0,0 +1,72 @@
+// open_file_cache.cpp
+#include "open_file_cache.h"
+
+OpenFileCache::OpenFileCache(std::size_t capacity, std::chrono::steady_clock::duration valid)
+    : capacity_(capacity), valid_(valid) {}
+
+std::shared_ptr<const OpenFileCache::Entry> OpenFileCache::get(const std::string& key, const Loader& loader) {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t generation = 0;
+    if (capacity_ > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation = generation_;
+        auto it = entries_.find(key);
+        if (it != entries_.end() && now < it->second.expires) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second.entry;
+        }
+    }
+
+    // 打开文件可能触发磁盘 I/O，不持锁
+    auto entry = std::make_shared<const Entry>(loader());
+    if (capacity_ == 0 || static_cast<int>(entry->status) >= 500) {
+        return entry;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_) {
+        // 加载期间发生了失效，结果可能已经过时
+        return entry;
+    }
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        it->second.entry = entry;
+        it->second.expires = now + valid_;
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return entry;
+    }
+    if (entries_.size() >= capacity_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(key);
+    entries_.emplace(key, Node{entry, now + valid_, lru_.begin()});
+    return entry;
+}
+
+std::size_t OpenFileCache::invalidate(const Matcher& match) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    std::size_t erased = 0;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (match(it->first, *it->second.entry)) {
+            lru_.erase(it->second.lru);
+            it = entries_.erase(it);
+            erased++;
+        } else {
+            ++it;
+        }
+    }
+    return erased;
+}
+
+void OpenFileCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+}
+
+std::size_t OpenFileCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
@@ -1,57 +1,476 @@
 // static_file_controller.cpp
 #include "static_file_controller.h"
-#include <fstream>
-#include <sstream>
+#include "logger.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
 #include <filesystem>
+#include <string_view>
 
-StaticFileController::StaticFileController(const std::string& rootDir)
-    : rootDir_(rootDir) {
+StaticFileController::StaticFileController(const std::string& rootDir, const StaticFileOptions& options,
+                                           std::shared_ptr<ResponseCompressor> compressor)
+    : rootDir_(rootDir),
+      precompressed_(options.precompressed),
+      compressor_(std::move(compressor)),
+      openFileCache_(options.openFileCacheMax, options.openFileCacheValid),
+      contentCache_(options.contentCacheSize, options.contentCacheMaxObject, options.contentCacheMinUses,
+                    options.openFileCacheValid) {
+    char resolved[PATH_MAX];
+    canonicalRoot_ = realpath(rootDir_.c_str(), resolved) ? resolved : std::filesystem::absolute(rootDir_).string();
     initMimeTypes();
+
+    if (options.watchFiles && (options.openFileCacheMax > 0 || contentCache_.enabled())) {
+        try {
+            watcher_ = std::make_unique<FileWatcher>(canonicalRoot_, [this](const std::vector<std::string>& paths) {
+                onFilesChanged(paths);
+            });
+        } catch (const std::exception& e) {
+            LOG_WARN("Static file watching disabled (%s), relying on cache expiry", e.what());
+        }
+    }
+}
+
+// RFC 9110 的 IMF-fixdate，例如 Sun, 06 Nov 1994 08:49:37 GMT
+static std::string formatHttpDate(time_t time) {
+    struct tm tm;
+    gmtime_r(&time, &tm);
+    char buffer[64];
+    std::size_t n = strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return std::string(buffer, n);
+}
+
+static bool parseHttpDate(const std::string& value, time_t& time) {
+    struct tm tm = {};
+    const char* end = strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    if (!end || *end != '\0') {
+        return false;
+    }
+    time = timegm(&tm);
+    return true;
+}
+
+// If-None-Match 使用弱比较：忽略 W/ 前缀，逗号分隔的列表中任一匹配或为 * 即匹配
+static bool etagMatches(const std::string& header, const std::string& etag) {
+    std::string_view tag = etag;
+    if (tag.substr(0, 2) == "W/") {
+        tag.remove_prefix(2);
+    }
+    std::size_t pos = 0;
+    while (pos < header.size()) {
+        std::size_t comma = header.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = header.size();
+        }
+        std::string_view item = trim_ows(std::string_view(header.data() + pos, comma - pos));
+        if (item == "*") {
+            return true;
+        }
+        if (item.substr(0, 2) == "W/") {
+            item.remove_prefix(2);
+        }
+        if (item == tag) {
+            return true;
+        }
+        pos = comma + 1;
+    }
+    return false;
+}
+
+// 支持的预压缩文件，按优先级排列
+struct Precompressed {
+    unsigned coding;
+    const char* suffix;
+};
+static constexpr Precompressed PRECOMPRESSED[] = {{CODING_BR, ".br"}, {CODING_GZIP, ".gz"}};
+
+// 强校验器：inode、大小和纳秒级修改时间任一变化都会改变 ETag
+static std::string formatEtag(const struct stat& st) {
+    char etag[64];
+    std::snprintf(etag, sizeof(etag), "\"%lx-%lx-%llx\"", static_cast<unsigned long>(st.st_ino),
+                  static_cast<unsigned long>(st.st_size),
+                  static_cast<unsigned long long>(st.st_mtim.tv_sec) * 1000000000ULL + st.st_mtim.tv_nsec);
+    return etag;
+}
+
+// 解析 Range 头 (bytes=first-last, first-, -suffix)，区间以闭区间保存在 ranges 中
+// 语法错误、非 bytes 单位 (单位大小写不敏感) 或区间过多时返回 NONE，按 RFC 9110 忽略 Range 返回完整内容
+static RangeResult parseRanges(const std::string& header, std::size_t size,
+                               std::vector<std::pair<std::size_t, std::size_t>>& ranges) {
+    constexpr std::string_view prefix = "bytes=";
+    if (!equals_ignore_case(std::string_view(header).substr(0, prefix.size()), prefix)) {
+        return RangeResult::NONE;
+    }
+    auto parseNumber = [](std::string_view text, std::size_t& value) {
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return !text.empty() && ec == std::errc() && end == text.data() + text.size();
+    };
+
+    std::size_t specs = 0;
+    std::size_t pos = prefix.size();
+    while (pos <= header.size()) {
+        std::size_t comma = header.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = header.size();
+        }
+        std::string_view spec = trim_ows(std::string_view(header.data() + pos, comma - pos));
+        pos = comma + 1;
+        if (spec.empty()) {
+            continue;
+        }
+        if (++specs > StaticFileController::MAX_RANGES) {
+            return RangeResult::NONE;
+        }
+
+        std::size_t dash = spec.find('-');
+        if (dash == std::string_view::npos) {
+            return RangeResult::NONE;
+        }
+        std::size_t first, last;
+        if (dash == 0) {
+            // 后缀区间：最后 n 个字节
+            std::size_t suffix;
+            if (!parseNumber(spec.substr(1), suffix)) {
+                return RangeResult::NONE;
+            }
+            if (suffix == 0 || size == 0) {
+                continue;
+            }
+            first = suffix < size ? size - suffix : 0;
+            last = size - 1;
+        } else {
+            if (!parseNumber(spec.substr(0, dash), first)) {
+                return RangeResult::NONE;
+            }
+            last = size - 1;
+            if (dash + 1 < spec.size()) {
+                if (!parseNumber(spec.substr(dash + 1), last) || last < first) {
+                    return RangeResult::NONE;
+                }
+                last = std::min(last, size - 1);
+            }
+            if (first >= size) {
+                continue;
+            }
+        }
+        ranges.emplace_back(first, last);
+    }
+    if (specs == 0) {
+        return RangeResult::NONE;
+    }
+    if (ranges.empty()) {
+        return RangeResult::UNSATISFIABLE;
+    }
+
+    // 合并重叠和相邻的区间 (RFC 9110 14.2 允许合并，不要求保持请求中的顺序)
+    std::sort(ranges.begin(), ranges.end());
+    std::size_t merged = 0;
+    for (std::size_t i = 1; i < ranges.size(); i++) {
+        if (ranges[i].first <= ranges[merged].second + 1) {
+            ranges[merged].second = std::max(ranges[merged].second, ranges[i].second);
+        } else {
+            ranges[++merged] = ranges[i];
+        }
+    }
+    ranges.resize(merged + 1);
+    return RangeResult::SATISFIABLE;
 }
 
 HttpResponse StaticFileController::serveFile(const HttpRequest& req, const std::unordered_map<std::string, std::string>& params) {
-    std::string path = rootDir_ + req.getPath();
-    
-    // 规范化路径
-    std::filesystem::path fsPath = std::filesystem::absolute(path);
-    path = fsPath.string();
+    // 条件请求需要比较校验器，范围请求只返回部分内容，都不走内容缓存
+    bool conditional = (req.getMethod() == HttpMethod::GET || req.getMethod() == HttpMethod::HEAD) &&
+                       (req.hasHeader("If-None-Match") || req.hasHeader("If-Modified-Since"));
+    bool ranged = req.getMethod() == HttpMethod::GET && req.hasHeader("Range");
+    // 范围请求只针对原文件，不发送压缩表示
+    bool negotiates = precompressed_ || (compressor_ && compressor_->enabled());
+    unsigned accepted = negotiates && !ranged ? parseAcceptEncoding(req.getHeader("Accept-Encoding")) : 0;
+    // 同一路径按客户端接受的编码分别缓存
+    std::string cacheKey = accepted ? req.getPath() + '\n' + static_cast<char>('0' + accepted) : req.getPath();
+
+    // 内容缓存命中：直接返回预先序列化好的响应；HEAD 与 GET 共用同一条目，由服务器只发送其中的头部
+    if (!conditional && !ranged) {
+        if (auto cached = contentCache_.find(cacheKey)) {
+            auto resp = HttpResponse::newHttpResponse();
+            resp.setStatusCode(HttpStatusCode::OK).setSerialized(std::move(cached));
+            return resp;
+        }
+    }
+
+    // 先取内容缓存的失效代数再查打开文件缓存，期间文件发生变化时不会把旧内容放进内容缓存
+    uint64_t generation = contentCache_.generation();
+    auto entry = openFileCache_.get(req.getPath(), [&] {
+        return openFile(req.getPath());
+    });
+
+    switch (entry->status) {
+        case HttpStatusCode::OK:
+            break;
+        case HttpStatusCode::NOT_FOUND:
+            return createErrorResponse(HttpStatusCode::NOT_FOUND, "404 Not Found");
+        case HttpStatusCode::FORBIDDEN:
+            return createErrorResponse(HttpStatusCode::FORBIDDEN, "403 Forbidden");
+        default:
+            return createErrorResponse(HttpStatusCode::INTERNAL_SERVER_ERROR, "500 Internal Server Error");
+    }
 
-    // 安全检查
-    if (!isPathSafe(path)) {
-        return createErrorResponse(HttpStatusCode::FORBIDDEN, "403 Forbidden");
+    const OpenFileCache::Encoded* encoded = selectEncoding(*entry, accepted);
+    // 没有合适的预压缩文件时即时压缩，file 为空，压缩结果由 compressor_ 按 ETag 缓存
+    OpenFileCache::Encoded compressed;
+    unsigned coding = compressor_ ? compressor_->negotiate(accepted) : 0;
+    if (!encoded && coding && compressor_->compressible(entry->mimeType, entry->size)) {
+        compressed.coding = ResponseCompressor::codingName(coding);
+        // 压缩输出与 zlib 级别有关，只能作为弱校验器
+        compressed.etag = "W/" + entry->etag.substr(0, entry->etag.size() - 1) + "-" + compressed.coding + "\"";
+        encoded = &compressed;
+    }
+    if (conditional && isNotModified(req, *entry, encoded)) {
+        return createFileResponse(*entry, HttpStatusCode::NOT_MODIFIED, encoded);
+    }
+    if (ranged) {
+        if (auto resp = createRangeResponse(req, *entry)) {
+            return std::move(*resp);
+        }
     }
 
-    // 如果是目录，尝试提供 index.html
-    if (std::filesystem::is_directory(path)) {
-        path += "/index.html";
+    bool interim = false;
+    if (encoded == &compressed) {
+        CompressedFile result = compressor_->compressFile(entry->etag, entry->file, entry->size, coding);
+        if (result.data) {
+            auto resp = createFileResponse(*entry, HttpStatusCode::OK, encoded);
+            resp.setBody(*result.data);
+            if (contentCache_.admit(cacheKey, result.data->size())) {
+                auto serialized = std::make_shared<const std::string>(resp.toString());
+                contentCache_.insert(cacheKey, entry->path, serialized, generation);
+                resp.setSerialized(std::move(serialized));
+            }
+            return resp;
+        }
+        // 超过 compression_max_length、压缩后不更小或读取失败：发送原文件；
+        // 后台压缩完成之前的原文件响应不放入内容缓存，否则压缩结果在缓存过期前用不上
+        interim = result.pending;
+        encoded = nullptr;
     }
 
-    // 检查文件是否存在
-    if (!std::filesystem::exists(path)) {
-        return createErrorResponse(HttpStatusCode::NOT_FOUND, "404 Not Found");
+    std::size_t size = encoded ? encoded->size : entry->size;
+    if (!interim && contentCache_.admit(cacheKey, size)) {
+        if (auto serialized = serializeFile(*entry, encoded)) {
+            contentCache_.insert(cacheKey, entry->path, serialized, generation);
+            auto resp = HttpResponse::newHttpResponse();
+            resp.setStatusCode(HttpStatusCode::OK).setSerialized(std::move(serialized));
+            return resp;
+        }
+    }
+
+    // 响应体共享缓存中的 fd，发送时由 sendfile 从页缓存直接写入 socket
+    auto resp = createFileResponse(*entry, HttpStatusCode::OK, encoded);
+    resp.setBodyFile(encoded ? encoded->file : entry->file, 0, size);
+    return resp;
+}
+
+bool StaticFileController::isNotModified(const HttpRequest& req, const OpenFileCache::Entry& entry,
+                                         const OpenFileCache::Encoded* encoded) const {
+    // 同时存在时 If-None-Match 优先，If-Modified-Since 被忽略 (RFC 9110 13.2.2)
+    if (req.hasHeader("If-None-Match")) {
+        return etagMatches(req.getHeader("If-None-Match"), encoded ? encoded->etag : entry.etag);
     }
+    time_t since;
+    return parseHttpDate(req.getHeader("If-Modified-Since"), since) && entry.mtime <= since;
+}
 
-    // 读取文件内容
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
-        return createErrorResponse(HttpStatusCode::INTERNAL_SERVER_ERROR, "500 Internal Server Error");
+std::optional<HttpResponse> StaticFileController::createRangeResponse(const HttpRequest& req,
+                                                                      const OpenFileCache::Entry& entry) const {
+    // If-Range 与当前版本不一致时忽略 Range，返回完整的新内容；ETag 必须强匹配
+    if (req.hasHeader("If-Range")) {
+        std::string validator = req.getHeader("If-Range");
+        time_t date;
+        bool matches = !validator.empty() && validator.front() == '"' ? validator == entry.etag
+                     : parseHttpDate(validator, date) && date == entry.mtime;
+        if (!matches) {
+            return std::nullopt;
+        }
     }
 
-    std::ostringstream content;
-    content << file.rdbuf();
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    switch (parseRanges(req.getHeader("Range"), entry.size, ranges)) {
+        case RangeResult::NONE:
+            return std::nullopt;
+        case RangeResult::UNSATISFIABLE: {
+            auto resp = createErrorResponse(HttpStatusCode::RANGE_NOT_SATISFIABLE, "416 Range Not Satisfiable");
+            resp.setHeader("Content-Range", "bytes */" + std::to_string(entry.size));
+            return resp;
+        }
+        case RangeResult::SATISFIABLE:
+            break;
+    }
 
-    // 创建响应
+    auto resp = createFileResponse(entry, HttpStatusCode::PARTIAL_CONTENT);
+    char line[128];
+    if (ranges.size() == 1) {
+        auto [first, last] = ranges.front();
+        std::snprintf(line, sizeof(line), "bytes %zu-%zu/%zu", first, last, entry.size);
+        resp.setHeader("Content-Range", line);
+        resp.setBodyFile(entry.file, static_cast<off_t>(first), last - first + 1);
+        return resp;
+    }
+
+    // 多个区间：multipart/byteranges，分段头放在内存中，各段内容仍然用 sendfile 发送
+    static std::atomic<uint64_t> boundaryCounter{0};
+    char boundary[32];
+    std::snprintf(boundary, sizeof(boundary), "%020llu",
+                  static_cast<unsigned long long>(++boundaryCounter));
+    resp.setHeader("Content-Type", std::string("multipart/byteranges; boundary=") + boundary);
+    for (auto [first, last] : ranges) {
+        std::snprintf(line, sizeof(line), "bytes %zu-%zu/%zu", first, last, entry.size);
+        resp.appendBodySegment(std::string("\r\n--") + boundary + "\r\nContent-Type: " + entry.mimeType +
+                               "\r\nContent-Range: " + line + "\r\n\r\n");
+        resp.appendBodyFile(entry.file, static_cast<off_t>(first), last - first + 1);
+    }
+    resp.appendBodySegment(std::string("\r\n--") + boundary + "--\r\n");
+    return resp;
+}
+
+HttpResponse StaticFileController::createFileResponse(const OpenFileCache::Entry& entry, HttpStatusCode code,
+                                                     const OpenFileCache::Encoded* encoded) const {
     auto resp = HttpResponse::newHttpResponse();
-    resp.setStatusCode(HttpStatusCode::OK);
-    resp.setHeader("Content-Type", getMimeType(path));
-    resp.setBody(content.str());
+    resp.setStatusCode(code);
+    if (code != HttpStatusCode::NOT_MODIFIED) {
+        resp.setHeader("Content-Type", entry.mimeType);
+        if (encoded) {
+            resp.setHeader("Content-Encoding", encoded->coding);
+        }
+    }
+    // 存在预压缩文件或可以即时压缩时响应随 Accept-Encoding 变化，原文件的响应也要告知缓存
+    if (!entry.encodings.empty() || (compressor_ && compressor_->compressible(entry.mimeType, entry.size))) {
+        resp.setHeader("Vary", "Accept-Encoding");
+    }
+    resp.setHeader("ETag", encoded ? encoded->etag : entry.etag);
+    resp.setHeader("Last-Modified", entry.lastModified);
+    resp.setHeader("Accept-Ranges", "bytes");
 
     // 设置 Cache-Control 头部 (可选)
     resp.setHeader("Cache-Control", "public, max-age=3600");
-
     return resp;
 }
 
+std::shared_ptr<const std::string> StaticFileController::serializeFile(const OpenFileCache::Entry& entry,
+                                                                      const OpenFileCache::Encoded* encoded) const {
+    std::size_t size = encoded ? encoded->size : entry.size;
+    int fd = encoded ? encoded->file->get() : entry.file->get();
+    std::string body(size, '\0');
+    std::size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, body.data() + done, size - done, static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return nullptr;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+
+    auto resp = createFileResponse(entry, HttpStatusCode::OK, encoded);
+    resp.setBody(body);
+    return std::make_shared<const std::string>(resp.toString());
+}
+
+OpenFileCache::Entry StaticFileController::openFile(const std::string& requestPath) const {
+    OpenFileCache::Entry entry;
+    std::string path = rootDir_ + requestPath;
+    entry.path = lexicalPath(requestPath);
+
+    // 最多两轮：请求路径本身，是目录时再尝试其中的 index.html
+    for (int attempt = 0; attempt < 2; attempt++) {
+        char resolved[PATH_MAX];
+        if (!realpath(path.c_str(), resolved)) {
+            entry.status = (errno == ENOENT || errno == ENOTDIR) ? HttpStatusCode::NOT_FOUND
+                         : errno == EACCES ? HttpStatusCode::FORBIDDEN
+                         : HttpStatusCode::INTERNAL_SERVER_ERROR;
+            return entry;
+        }
+
+        entry.path = resolved;
+
+        // 安全检查在解析符号链接和 .. 之后进行
+        if (!isPathSafe(resolved)) {
+            entry.status = HttpStatusCode::FORBIDDEN;
+            return entry;
+        }
+
+        int fd = open(resolved, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            entry.status = errno == EACCES ? HttpStatusCode::FORBIDDEN : HttpStatusCode::INTERNAL_SERVER_ERROR;
+            return entry;
+        }
+        auto file = std::make_shared<const FileDescriptor>(fd);
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            entry.status = HttpStatusCode::INTERNAL_SERVER_ERROR;
+            return entry;
+        }
+
+        // 如果是目录，尝试提供 index.html
+        if (S_ISDIR(st.st_mode)) {
+            path = std::string(resolved) + "/index.html";
+            entry.path = path;
+            continue;
+        }
+        if (!S_ISREG(st.st_mode)) {
+            entry.status = HttpStatusCode::NOT_FOUND;
+            return entry;
+        }
+
+        entry.file = std::move(file);
+        entry.size = static_cast<std::size_t>(st.st_size);
+        entry.mtime = st.st_mtime;
+        entry.etag = formatEtag(st);
+        entry.lastModified = formatHttpDate(st.st_mtime);
+        entry.mimeType = getMimeType(resolved);
+        if (precompressed_) {
+            openEncodings(resolved, entry);
+        }
+        return entry;
+    }
+    entry.status = HttpStatusCode::NOT_FOUND;
+    return entry;
+}
+
+void StaticFileController::openEncodings(const std::string& resolved, OpenFileCache::Entry& entry) const {
+    for (const auto& precompressed : PRECOMPRESSED) {
+        // 与已通过安全检查的原文件在同一目录，拒绝符号链接即可保证仍在根目录之下
+        int fd = open((resolved + precompressed.suffix).c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+        if (fd < 0) {
+            continue;
+        }
+        auto file = std::make_shared<const FileDescriptor>(fd);
+        struct stat st;
+        if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        entry.encodings.push_back({ResponseCompressor::codingName(precompressed.coding), std::move(file), static_cast<std::size_t>(st.st_size),
+                                   formatEtag(st)});
+    }
+}
+
+const OpenFileCache::Encoded* StaticFileController::selectEncoding(const OpenFileCache::Entry& entry,
+                                                                   unsigned accepted) {
+    for (const auto& encoded : entry.encodings) {
+        for (const auto& precompressed : PRECOMPRESSED) {
+            if ((accepted & precompressed.coding) && encoded.coding == ResponseCompressor::codingName(precompressed.coding)) {
+                return &encoded;
+            }
+        }
+    }
+    return nullptr;
+}
+
 void StaticFileController::initMimeTypes() {
     mimeTypes_ = {
         {".html", "text/html"},
@@ -82,20 +501,57 @@ std::string StaticFileController::getMimeType(const std::string& filename) const
     return "application/octet-stream";  // 默认 MIME 类型
 }
 
-bool StaticFileController::isPathSafe(const std::string& path) const {
-    std::filesystem::path canonicalPath = std::filesystem::canonical(path);
-    std::filesystem::path rootPath = std::filesystem::canonical(rootDir_);
-    
-    // 检查 canonicalPath 是否以 rootPath 开头
-    auto rootPathStr = rootPath.string();
-    auto canonicalPathStr = canonicalPath.string();
-    
-    if (canonicalPathStr.length() < rootPathStr.length()) {
-        return false;  // 路径长度小于根目录，肯定不在根目录内
-    }
-    
-    // 使用 string 的 compare 函数检查前缀
-    return canonicalPathStr.compare(0, rootPathStr.length(), rootPathStr) == 0;
+bool StaticFileController::isPathSafe(const std::string& canonicalPath) const {
+    // 检查 canonicalPath 是否为根目录本身或位于根目录之下，前缀必须在路径分隔符处结束
+    if (canonicalPath.compare(0, canonicalRoot_.length(), canonicalRoot_) != 0) {
+        return false;
+    }
+    return canonicalPath.length() == canonicalRoot_.length()
+        || canonicalRoot_.back() == '/'
+        || canonicalPath[canonicalRoot_.length()] == '/';
+}
+
+std::string StaticFileController::lexicalPath(const std::string& requestPath) const {
+    std::string path = std::filesystem::path(canonicalRoot_ + "/" + requestPath).lexically_normal().string();
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
+    }
+    return path;
+}
+
+void StaticFileController::onFilesChanged(const std::vector<std::string>& paths) {
+    std::unordered_set<std::string> changed(paths.begin(), paths.end());
+    // 预压缩文件的变化同样影响原文件的条目
+    for (const auto& path : paths) {
+        for (const auto& precompressed : PRECOMPRESSED) {
+            std::string_view suffix = precompressed.suffix;
+            if (path.size() > suffix.size() && path.ends_with(suffix)) {
+                changed.insert(path.substr(0, path.size() - suffix.size()));
+            }
+        }
+    }
+    // 先失效打开文件缓存再失效内容缓存：内容缓存的插入基于打开文件缓存的结果
+    std::size_t files = openFileCache_.invalidate([&](const std::string& key, const OpenFileCache::Entry& entry) {
+        return isAffected(entry.path, changed) || isAffected(lexicalPath(key), changed);
+    });
+    std::size_t contents = contentCache_.invalidate([&](const std::string& key, const std::string& path) {
+        return isAffected(path, changed) || isAffected(lexicalPath(key.substr(0, key.find('\n'))), changed);
+    });
+    LOG_DEBUG("%zu file changes invalidated %zu open files and %zu cached responses",
+              paths.size(), files, contents);
+}
+
+bool StaticFileController::isAffected(const std::string& path, const std::unordered_set<std::string>& changed) {
+    // path 本身或它的任一上级目录发生了变化
+    if (changed.count(path)) {
+        return true;
+    }
+    for (std::size_t pos = path.rfind('/'); pos != std::string::npos && pos > 0; pos = path.rfind('/', pos - 1)) {
+        if (changed.count(path.substr(0, pos))) {
+            return true;
+        }
+    }
+    return false;
 }
 
 HttpResponse StaticFileController::createErrorResponse(HttpStatusCode code, const std::string& message) const {
@@ -0,0 +1,572 @@
+#include <gtest/gtest.h>
+#include "static_file_controller.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// 每个用例一个临时目录：<tmp>/public 为站点根目录，<tmp>/public-secret 与根目录前缀相同但在根目录之外
+class StaticFileControllerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir[] = "/tmp/static_file_test_XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        base_ = dir;
+        root_ = base_ / "public";
+        fs::create_directories(root_ / "docs");
+        fs::create_directories(base_ / "public-secret");
+        writeFile(root_ / "index.html", "<h1>home</h1>");
+        writeFile(root_ / "docs" / "index.html", "<h1>docs</h1>");
+        writeFile(root_ / "app.js", "console.log(1);");
+        writeFile(base_ / "public-secret" / "key.txt", "secret");
+        fs::create_symlink(base_ / "public-secret" / "key.txt", root_ / "link.txt");
+    }
+
+    void TearDown() override {
+        fs::remove_all(base_);
+    }
+
+    static void writeFile(const fs::path& path, const std::string& content) {
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    static HttpRequest makeRequest(const std::string& path) {
+        HttpRequest request;
+        request.setMethod(HttpMethod::GET);
+        request.setPath(path);
+        return request;
+    }
+
+    // 文件响应体通过 fd 读回内容，预先序列化的响应取头部之后的部分
+    static std::string readBody(HttpResponse& response) {
+        if (response.isSerialized()) {
+            std::string bytes = response.toString();
+            return bytes.substr(bytes.find("\r\n\r\n") + 4);
+        }
+        if (!response.hasBodyFile()) {
+            return response.getBody();
+        }
+        std::string content;
+        for (const auto& segment : response.takeBodySegments()) {
+            if (!segment.file.file) {
+                content += segment.data;
+                continue;
+            }
+            std::string part(segment.file.length, '\0');
+            EXPECT_EQ(pread(segment.file.file->get(), part.data(), part.size(), segment.file.offset),
+                      static_cast<ssize_t>(part.size()));
+            content += part;
+        }
+        return content;
+    }
+
+    fs::path base_;
+    fs::path root_;
+};
+
+TEST(OpenFileCacheTest, ReusesEntryUntilExpired) {
+    int loads = 0;
+    auto loader = [&] {
+        loads++;
+        return OpenFileCache::Entry{};
+    };
+
+    OpenFileCache cache(8, std::chrono::hours(1));
+    auto first = cache.get("/a", loader);
+    auto second = cache.get("/a", loader);
+    EXPECT_EQ(loads, 1);
+    EXPECT_EQ(first, second);
+
+    OpenFileCache expiring(8, std::chrono::steady_clock::duration::zero());
+    expiring.get("/a", loader);
+    expiring.get("/a", loader);
+    EXPECT_EQ(loads, 3);
+}
+
+TEST(OpenFileCacheTest, EvictsLeastRecentlyUsed) {
+    int loads = 0;
+    auto loader = [&] {
+        loads++;
+        return OpenFileCache::Entry{};
+    };
+
+    OpenFileCache cache(2, std::chrono::hours(1));
+    cache.get("/a", loader);
+    cache.get("/b", loader);
+    cache.get("/a", loader);  // /a 变为最近使用
+    cache.get("/c", loader);  // 淘汰 /b
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(loads, 3);
+
+    cache.get("/a", loader);
+    EXPECT_EQ(loads, 3);
+    cache.get("/b", loader);
+    EXPECT_EQ(loads, 4);
+}
+
+TEST(OpenFileCacheTest, DoesNotCacheServerErrors) {
+    int loads = 0;
+    auto loader = [&] {
+        loads++;
+        OpenFileCache::Entry entry;
+        entry.status = HttpStatusCode::INTERNAL_SERVER_ERROR;
+        return entry;
+    };
+
+    OpenFileCache cache(8, std::chrono::hours(1));
+    cache.get("/a", loader);
+    cache.get("/a", loader);
+    EXPECT_EQ(loads, 2);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(ContentCacheTest, AdmitsAfterMinUses) {
+    ContentCache cache(1 << 20, 1024, 2, std::chrono::hours(1));
+    EXPECT_FALSE(cache.admit("/a", 100));
+    EXPECT_TRUE(cache.admit("/a", 100));
+    EXPECT_FALSE(cache.admit("/big", 4096));
+    EXPECT_FALSE(cache.admit("/big", 4096));
+
+    cache.insert("/a", "/root/a", std::make_shared<const std::string>("response"), cache.generation());
+    ASSERT_NE(cache.find("/a"), nullptr);
+    EXPECT_EQ(*cache.find("/a"), "response");
+    EXPECT_EQ(cache.find("/b"), nullptr);
+
+    cache.erase("/a");
+    EXPECT_EQ(cache.find("/a"), nullptr);
+    EXPECT_EQ(cache.bytes(), 0u);
+}
+
+TEST(ContentCacheTest, StaysWithinByteCapacity) {
+    // 16 个分片，每个分片 1KB
+    ContentCache cache(16 * 1024, 1024, 1, std::chrono::hours(1));
+    for (int i = 0; i < 1000; i++) {
+        std::string key = "/";
+        key += std::to_string(i);
+        cache.insert(key, key, std::make_shared<const std::string>(200, 'x'), cache.generation());
+        EXPECT_LE(cache.bytes(), 16u * 1024);
+    }
+    EXPECT_GT(cache.bytes(), 8u * 1024);
+    // 最近插入的对象仍在缓存中
+    EXPECT_NE(cache.find("/999"), nullptr);
+}
+
+TEST(ContentCacheTest, ExpiresEntries) {
+    ContentCache cache(1 << 20, 1024, 1, std::chrono::steady_clock::duration::zero());
+    cache.insert("/a", "/root/a", std::make_shared<const std::string>("response"), cache.generation());
+    EXPECT_EQ(cache.find("/a"), nullptr);
+    EXPECT_EQ(cache.bytes(), 0u);
+}
+
+TEST(ContentCacheTest, InvalidatesByPathAndRejectsStaleInserts) {
+    ContentCache cache(1 << 20, 1024, 1, std::chrono::hours(1));
+    cache.insert("/a", "/root/a", std::make_shared<const std::string>("a"), cache.generation());
+    cache.insert("/b", "/root/b", std::make_shared<const std::string>("b"), cache.generation());
+
+    uint64_t before = cache.generation();
+    EXPECT_EQ(cache.invalidate([](const std::string&, const std::string& path) { return path == "/root/a"; }), 1u);
+    EXPECT_EQ(cache.find("/a"), nullptr);
+    EXPECT_NE(cache.find("/b"), nullptr);
+
+    // 失效之前开始加载的内容不能再放回缓存
+    cache.insert("/a", "/root/a", std::make_shared<const std::string>("stale"), before);
+    EXPECT_EQ(cache.find("/a"), nullptr);
+}
+
+TEST_F(StaticFileControllerTest, ServesHotFilesFromContentCache) {
+    StaticFileOptions options;
+    options.watchFiles = false;
+    StaticFileController controller(root_.string(), options);
+
+    // 第一次走 sendfile，第二次准入后返回预先序列化的完整响应
+    auto first = controller.serveFile(makeRequest("/app.js"), {});
+    EXPECT_TRUE(first.hasBodyFile());
+    auto second = controller.serveFile(makeRequest("/app.js"), {});
+    ASSERT_TRUE(second.isSerialized());
+    std::string bytes = second.toString();
+    EXPECT_EQ(bytes.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(bytes.find("Content-Type: application/javascript\r\n"), std::string::npos);
+    EXPECT_NE(bytes.find("Content-Length: 15\r\n"), std::string::npos);
+    EXPECT_EQ(readBody(second), "console.log(1);");
+
+    // 命中时不访问文件系统：文件删除后仍返回缓存内容
+    fs::remove(root_ / "app.js");
+    auto third = controller.serveFile(makeRequest("/app.js"), {});
+    ASSERT_TRUE(third.isSerialized());
+    EXPECT_EQ(readBody(third), "console.log(1);");
+}
+
+TEST_F(StaticFileControllerTest, ServesFilesAndDirectoryIndex) {
+    StaticFileController controller(root_.string());
+
+    auto response = controller.serveFile(makeRequest("/app.js"), {});
+    EXPECT_EQ(response.getStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(response.getHeader("Content-Type"), "application/javascript");
+    EXPECT_EQ(readBody(response), "console.log(1);");
+
+    auto index = controller.serveFile(makeRequest("/"), {});
+    EXPECT_EQ(index.getStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(readBody(index), "<h1>home</h1>");
+
+    auto docs = controller.serveFile(makeRequest("/docs"), {});
+    EXPECT_EQ(docs.getHeader("Content-Type"), "text/html");
+    EXPECT_EQ(readBody(docs), "<h1>docs</h1>");
+}
+
+TEST_F(StaticFileControllerTest, RejectsMissingAndEscapingPaths) {
+    StaticFileController controller(root_.string());
+
+    EXPECT_EQ(controller.serveFile(makeRequest("/nope.html"), {}).getStatusCode(), HttpStatusCode::NOT_FOUND);
+    EXPECT_EQ(controller.serveFile(makeRequest("/app.js/x"), {}).getStatusCode(), HttpStatusCode::NOT_FOUND);
+    EXPECT_EQ(controller.serveFile(makeRequest("/../public-secret/key.txt"), {}).getStatusCode(),
+              HttpStatusCode::FORBIDDEN);
+    EXPECT_EQ(controller.serveFile(makeRequest("/link.txt"), {}).getStatusCode(), HttpStatusCode::FORBIDDEN);
+}
+
+TEST_F(StaticFileControllerTest, CachedFileSurvivesUntilExpiry) {
+    StaticFileOptions options;
+    options.openFileCacheMax = 16;
+    options.openFileCacheValid = std::chrono::seconds(3600);
+    options.contentCacheSize = 0;
+    options.watchFiles = false;
+    StaticFileController controller(root_.string(), options);
+
+    auto before = controller.serveFile(makeRequest("/app.js"), {});
+    EXPECT_EQ(readBody(before), "console.log(1);");
+
+    // 缓存持有已打开的 fd，文件被删除后在有效期内仍能提供原内容
+    fs::remove(root_ / "app.js");
+    auto cached = controller.serveFile(makeRequest("/app.js"), {});
+    EXPECT_EQ(cached.getStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(readBody(cached), "console.log(1);");
+
+    options.openFileCacheMax = 0;
+    StaticFileController uncached(root_.string(), options);
+    EXPECT_EQ(uncached.serveFile(makeRequest("/app.js"), {}).getStatusCode(), HttpStatusCode::NOT_FOUND);
+}
+
+TEST_F(StaticFileControllerTest, AnswersConditionalRequestsWithNotModified) {
+    StaticFileController controller(root_.string());
+    auto full = controller.serveFile(makeRequest("/app.js"), {});
+    std::string etag = full.getHeader("ETag");
+    std::string lastModified = full.getHeader("Last-Modified");
+    ASSERT_FALSE(etag.empty());
+    ASSERT_FALSE(lastModified.empty());
+    EXPECT_EQ(etag.front(), '"');
+
+    auto conditional = [&](const std::string& key, const std::string& value) {
+        HttpRequest request = makeRequest("/app.js");
+        request.setHeader(key, value);
+        return controller.serveFile(request, {});
+    };
+
+    auto notModified = conditional("If-None-Match", etag);
+    EXPECT_EQ(notModified.getStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_EQ(notModified.getHeader("ETag"), etag);
+    std::string bytes = notModified.toString();
+    EXPECT_EQ(bytes.find("Content-Length"), std::string::npos);
+    EXPECT_EQ(bytes.substr(bytes.size() - 4), "\r\n\r\n");
+
+    EXPECT_EQ(conditional("If-None-Match", "\"other\", W/" + etag).getStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_EQ(conditional("If-None-Match", "*").getStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_EQ(conditional("If-None-Match", "\"other\"").getStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(conditional("If-Modified-Since", lastModified).getStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_EQ(conditional("If-Modified-Since", "Thu, 01 Jan 1970 00:00:00 GMT").getStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(conditional("If-Modified-Since", "not a date").getStatusCode(), HttpStatusCode::OK);
+    // 头部名大小写不敏感
+    EXPECT_EQ(conditional("if-none-match", etag).getStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    EXPECT_EQ(conditional("IF-MODIFIED-SINCE", lastModified).getStatusCode(), HttpStatusCode::NOT_MODIFIED);
+
+    // If-None-Match 不匹配时忽略 If-Modified-Since
+    HttpRequest both = makeRequest("/app.js");
+    both.setHeader("If-None-Match", "\"other\"");
+    both.setHeader("If-Modified-Since", lastModified);
+    EXPECT_EQ(controller.serveFile(both, {}).getStatusCode(), HttpStatusCode::OK);
+}
+
+TEST_F(StaticFileControllerTest, ServesByteRanges) {
+    writeFile(root_ / "video.mp4", "0123456789abcdefghij");
+    StaticFileController controller(root_.string());
+    auto ranged = [&](const std::string& range) {
+        HttpRequest request = makeRequest("/video.mp4");
+        request.setHeader("Range", range);
+        return controller.serveFile(request, {});
+    };
+
+    auto full = controller.serveFile(makeRequest("/video.mp4"), {});
+    EXPECT_EQ(full.getHeader("Accept-Ranges"), "bytes");
+
+    auto single = ranged("bytes=2-5");
+    EXPECT_EQ(single.getStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+    EXPECT_EQ(single.getHeader("Content-Range"), "bytes 2-5/20");
+    EXPECT_NE(single.toString().find("Content-Length: 4\r\n"), std::string::npos);
+    EXPECT_EQ(readBody(single), "2345");
+
+    auto open = ranged("bytes=15-");
+    EXPECT_EQ(open.getHeader("Content-Range"), "bytes 15-19/20");
+    EXPECT_EQ(readBody(open), "fghij");
+    auto suffix = ranged("bytes=-3");
+    EXPECT_EQ(readBody(suffix), "hij");
+    auto clamped = ranged("bytes=18-100");
+    EXPECT_EQ(clamped.getHeader("Content-Range"), "bytes 18-19/20");
+
+    // 多区间：重叠的区间被合并，剩下两段组成 multipart/byteranges
+    auto multi = ranged("bytes=0-1, 10-12,11-13");
+    EXPECT_EQ(multi.getStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+    std::string type = multi.getHeader("Content-Type");
+    ASSERT_EQ(type.rfind("multipart/byteranges; boundary=", 0), 0u);
+    std::string boundary = type.substr(type.find('=') + 1);
+    std::string headers = multi.toString();
+    std::string body = readBody(multi);
+    EXPECT_EQ(body, "\r\n--" + boundary + "\r\nContent-Type: video/mp4\r\nContent-Range: bytes 0-1/20\r\n\r\n01"
+                    "\r\n--" + boundary + "\r\nContent-Type: video/mp4\r\nContent-Range: bytes 10-13/20\r\n\r\nabcd"
+                    "\r\n--" + boundary + "--\r\n");
+    EXPECT_NE(headers.find("Content-Length: " + std::to_string(body.size()) + "\r\n"), std::string::npos);
+
+    // 无法满足的区间返回 416，语法错误的 Range 被忽略
+    auto unsatisfiable = ranged("bytes=20-30");
+    EXPECT_EQ(unsatisfiable.getStatusCode(), HttpStatusCode::RANGE_NOT_SATISFIABLE);
+    EXPECT_EQ(unsatisfiable.getHeader("Content-Range"), "bytes */20");
+    EXPECT_EQ(ranged("bytes=5-2").getStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(ranged("items=0-1").getStatusCode(), HttpStatusCode::OK);
+    EXPECT_EQ(ranged("bytes=abc").getStatusCode(), HttpStatusCode::OK);
+
+    // 头部名和范围单位都大小写不敏感
+    HttpRequest lowercase = makeRequest("/video.mp4");
+    lowercase.setHeader("range", "Bytes=2-5");
+    lowercase.setHeader("if-range", full.getHeader("ETag"));
+    auto partial = controller.serveFile(lowercase, {});
+    EXPECT_EQ(partial.getStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+    EXPECT_EQ(readBody(partial), "2345");
+    HttpRequest uppercase = makeRequest("/video.mp4");
+    uppercase.setHeader("RANGE", "BYTES=2-5");
+    uppercase.setHeader("IF-RANGE", "\"stale\"");
+    EXPECT_EQ(controller.serveFile(uppercase, {}).getStatusCode(), HttpStatusCode::OK);
+
+    // If-Range 只在与当前版本一致时生效
+    HttpRequest current = makeRequest("/video.mp4");
+    current.setHeader("Range", "bytes=0-0");
+    current.setHeader("If-Range", full.getHeader("ETag"));
+    EXPECT_EQ(controller.serveFile(current, {}).getStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+    HttpRequest stale = makeRequest("/video.mp4");
+    stale.setHeader("Range", "bytes=0-0");
+    stale.setHeader("If-Range", "\"stale\"");
+    EXPECT_EQ(controller.serveFile(stale, {}).getStatusCode(), HttpStatusCode::OK);
+}
+
+// 监视线程异步失效缓存，轮询直到响应体变为期望值
+static bool waitForBody(StaticFileController& controller, const std::string& path,
+                        const std::function<bool(HttpResponse&)>& done) {
+    for (int i = 0; i < 200; i++) {
+        HttpRequest request;
+        request.setMethod(HttpMethod::GET);
+        request.setPath(path);
+        auto response = controller.serveFile(request, {});
+        if (done(response)) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+TEST_F(StaticFileControllerTest, WatcherInvalidatesChangedFiles) {
+    StaticFileOptions options;
+    options.openFileCacheValid = std::chrono::seconds(3600);
+    options.contentCacheMinUses = 1;
+    StaticFileController controller(root_.string(), options);
+
+    // 修改：内容缓存中的旧响应被替换
+    auto original = controller.serveFile(makeRequest("/app.js"), {});
+    EXPECT_EQ(readBody(original), "console.log(1);");
+    writeFile(root_ / "app.js", "console.log(2);");
+    EXPECT_TRUE(waitForBody(controller, "/app.js", [](HttpResponse& r) { return readBody(r) == "console.log(2);"; }));
+
+    // 删除后变为 404，重新创建后 404 结论也被失效
+    fs::remove(root_ / "app.js");
+    EXPECT_TRUE(waitForBody(controller, "/app.js", [](HttpResponse& r) {
+        return r.getStatusCode() == HttpStatusCode::NOT_FOUND;
+    }));
+    writeFile(root_ / "app.js", "console.log(3);");
+    EXPECT_TRUE(waitForBody(controller, "/app.js", [](HttpResponse& r) { return readBody(r) == "console.log(3);"; }));
+
+    // 新建目录中的文件和整个目录的替换
+    EXPECT_EQ(controller.serveFile(makeRequest("/v2/app.js"), {}).getStatusCode(), HttpStatusCode::NOT_FOUND);
+    fs::create_directories(base_ / "staging");
+    writeFile(base_ / "staging" / "app.js", "v2");
+    fs::rename(base_ / "staging", root_ / "v2");
+    EXPECT_TRUE(waitForBody(controller, "/v2/app.js", [](HttpResponse& r) { return readBody(r) == "v2"; }));
+    writeFile(root_ / "v2" / "app.js", "v2.1");
+    EXPECT_TRUE(waitForBody(controller, "/v2/app.js", [](HttpResponse& r) { return readBody(r) == "v2.1"; }));
+
+    // 目录索引：docs/index.html 被原子替换 (写临时文件后 rename)
+    auto index = controller.serveFile(makeRequest("/docs"), {});
+    EXPECT_EQ(readBody(index), "<h1>docs</h1>");
+    writeFile(root_ / "docs" / ".index.tmp", "<h1>docs v2</h1>");
+    fs::rename(root_ / "docs" / ".index.tmp", root_ / "docs" / "index.html");
+    EXPECT_TRUE(waitForBody(controller, "/docs", [](HttpResponse& r) { return readBody(r) == "<h1>docs v2</h1>"; }));
+}
+
+TEST_F(StaticFileControllerTest, NegotiatesPrecompressedFiles) {
+    writeFile(root_ / "app.js.br", "brotli");
+    writeFile(root_ / "app.js.gz", "gzipped");
+    writeFile(root_ / "docs" / "index.html.gz", "docs-gz");
+    StaticFileOptions options;
+    options.contentCacheMinUses = 1;
+    StaticFileController controller(root_.string(), options);
+    auto encoded = [&](const std::string& path, const std::string& acceptEncoding) {
+        HttpRequest request = makeRequest(path);
+        request.setHeader("Accept-Encoding", acceptEncoding);
+        return controller.serveFile(request, {});
+    };
+    auto encodedBody = [&](const std::string& path, const std::string& acceptEncoding) {
+        auto response = encoded(path, acceptEncoding);
+        return readBody(response);
+    };
+    auto header = [](HttpResponse& response, const std::string& name) {
+        std::string bytes = response.toString();
+        std::size_t pos = bytes.find("\r\n" + name + ": ");
+        return pos == std::string::npos ? std::string()
+             : bytes.substr(pos + name.size() + 4, bytes.find("\r\n", pos + 2) - pos - name.size() - 4);
+    };
+
+    // 原文件的响应同样带 Vary，Content-Type 保持原文件的类型
+    auto identity = controller.serveFile(makeRequest("/app.js"), {});
+    EXPECT_EQ(readBody(identity), "console.log(1);");
+    EXPECT_EQ(header(identity, "Vary"), "Accept-Encoding");
+    EXPECT_EQ(header(identity, "Content-Encoding"), "");
+
+    // 每个请求都经过内容缓存 (minUses = 1)，序列化后的响应按编码分别缓存
+    for (int round = 0; round < 2; round++) {
+        auto br = encoded("/app.js", "gzip, deflate, br");
+        EXPECT_EQ(readBody(br), "brotli");
+        EXPECT_EQ(header(br, "Content-Encoding"), "br");
+        EXPECT_EQ(header(br, "Content-Type"), "application/javascript");
+        EXPECT_EQ(header(br, "Vary"), "Accept-Encoding");
+        auto gzip = encoded("/app.js", "gzip, br;q=0");
+        EXPECT_EQ(readBody(gzip), "gzipped");
+        EXPECT_EQ(header(gzip, "Content-Encoding"), "gzip");
+        EXPECT_NE(header(gzip, "ETag"), header(br, "ETag"));
+        EXPECT_EQ(encodedBody("/app.js", "*;q=0.5, br;q=0.000"), "gzipped");
+        EXPECT_EQ(encodedBody("/app.js", "identity, deflate"), "console.log(1);");
+        EXPECT_EQ(encodedBody("/app.js", "GZIP"), "gzipped");
+    }
+    EXPECT_EQ(encodedBody("/docs", "br, gzip"), "docs-gz");
+
+    // 条件请求比较所选表示的 ETag
+    auto gzip = encoded("/app.js", "gzip");
+    HttpRequest conditional = makeRequest("/app.js");
+    conditional.setHeader("Accept-Encoding", "gzip");
+    conditional.setHeader("If-None-Match", header(gzip, "ETag"));
+    EXPECT_EQ(controller.serveFile(conditional, {}).getStatusCode(), HttpStatusCode::NOT_MODIFIED);
+    conditional.setHeader("Accept-Encoding", "br");
+    EXPECT_EQ(controller.serveFile(conditional, {}).getStatusCode(), HttpStatusCode::OK);
+
+    // 范围请求总是针对原文件
+    HttpRequest ranged = makeRequest("/app.js");
+    ranged.setHeader("Accept-Encoding", "br");
+    ranged.setHeader("Range", "bytes=0-6");
+    auto partial = controller.serveFile(ranged, {});
+    EXPECT_EQ(partial.getStatusCode(), HttpStatusCode::PARTIAL_CONTENT);
+    EXPECT_EQ(readBody(partial), "console");
+
+    // 预压缩文件的增删通过监视线程失效原文件的条目
+    fs::remove(root_ / "app.js.br");
+    bool fellBack = false;
+    for (int i = 0; i < 200 && !fellBack; i++) {
+        auto response = encoded("/app.js", "br, gzip");
+        fellBack = readBody(response) == "gzipped";
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(fellBack);
+
+    StaticFileOptions disabled;
+    disabled.precompressed = false;
+    StaticFileController plain(root_.string(), disabled);
+    HttpRequest request = makeRequest("/app.js");
+    request.setHeader("Accept-Encoding", "gzip");
+    auto response = plain.serveFile(request, {});
+    EXPECT_EQ(readBody(response), "console.log(1);");
+    EXPECT_EQ(header(response, "Vary"), "");
+}
+
+TEST_F(StaticFileControllerTest, CompressesFilesWithoutPrecompressedVariant) {
+    std::string css;
+    for (int i = 0; i < 100; i++) {
+        css += ".rule-" + std::to_string(i) + " { color: red; }\n";
+    }
+    writeFile(root_ / "site.css", css);
+    writeFile(root_ / "site.css.br", "brotli");
+    CompressionOptions compression;
+    compression.enabled = true;
+    auto compressor = std::make_shared<ResponseCompressor>(compression);
+    StaticFileController controller(root_.string(), {}, compressor);
+    auto serve = [&](const std::string& path, const std::string& acceptEncoding) {
+        HttpRequest request = makeRequest(path);
+        request.setHeader("Accept-Encoding", acceptEncoding);
+        return controller.serveFile(request, {});
+    };
+
+    // 预压缩文件优先，其次即时压缩，第二次请求进入内容缓存
+    auto br = serve("/site.css", "gzip, br");
+    EXPECT_EQ(readBody(br), "brotli");
+    for (int round = 0; round < 2; round++) {
+        auto gzip = serve("/site.css", "gzip");
+        std::string bytes = gzip.toString();
+        EXPECT_NE(bytes.find("Content-Encoding: gzip\r\n"), std::string::npos);
+        EXPECT_NE(bytes.find("Vary: Accept-Encoding\r\n"), std::string::npos);
+        EXPECT_NE(bytes.find("ETag: W/\""), std::string::npos);
+        EXPECT_LT(readBody(gzip).size(), css.size());
+    }
+    EXPECT_GT(compressor->cacheBytes(), 0u);
+
+    // 小于 minLength 的文件不压缩，也不带 Vary
+    auto small = serve("/app.js", "gzip");
+    EXPECT_EQ(readBody(small), "console.log(1);");
+    EXPECT_EQ(small.getHeader("Vary"), "");
+
+    // 即时压缩的表示同样支持条件请求
+    auto gzip = serve("/site.css", "gzip");
+    std::string bytes = gzip.toString();
+    std::size_t pos = bytes.find("ETag: ") + 6;
+    HttpRequest conditional = makeRequest("/site.css");
+    conditional.setHeader("Accept-Encoding", "gzip");
+    conditional.setHeader("If-None-Match", bytes.substr(pos, bytes.find("\r\n", pos) - pos));
+    EXPECT_EQ(controller.serveFile(conditional, {}).getStatusCode(), HttpStatusCode::NOT_MODIFIED);
+
+    // Accept-Encoding 的头部名和编码名都大小写不敏感
+    HttpRequest lowercase = makeRequest("/site.css");
+    lowercase.setHeader("accept-encoding", "GZIP");
+    EXPECT_NE(controller.serveFile(lowercase, {}).toString().find("Content-Encoding: gzip\r\n"), std::string::npos);
+}
+
+TEST_F(StaticFileControllerTest, CompressesLargeFilesInBackground) {
+    std::string css;
+    for (int i = 0; i < 100; i++) {
+        css += ".rule-" + std::to_string(i) + " { color: red; }\n";
+    }
+    writeFile(root_ / "site.css", css);
+    CompressionOptions compression;
+    compression.enabled = true;
+    compression.inlineLength = css.size() - 1;
+    StaticFileOptions options;
+    options.contentCacheMinUses = 1;
+    StaticFileController controller(root_.string(), options, std::make_shared<ResponseCompressor>(compression));
+    HttpRequest request = makeRequest("/site.css");
+    request.setHeader("Accept-Encoding", "gzip");
+
+    // 第一次请求不等压缩，发送原文件；这个过渡响应不进入内容缓存，压缩完成后改发压缩结果
+    auto first = controller.serveFile(request, {});
+    EXPECT_EQ(readBody(first), css);
+    EXPECT_EQ(first.getHeader("Vary"), "Accept-Encoding");
+    bool compressed = false;
+    for (int i = 0; i < 200 && !compressed; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        compressed = controller.serveFile(request, {}).toString().find("Content-Encoding: gzip\r\n") != std::string::npos;
+    }
+    EXPECT_TRUE(compressed);
+}
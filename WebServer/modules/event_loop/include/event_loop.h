@@ -0,0 +1,63 @@
+#pragma once
+
+#include "timing_wheel.h"
+
+#include <sys/epoll.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 一个线程一个事件循环 (one loop per thread)
+// 除 queueInLoop/runInLoop/quit 外，其余方法只能在所属线程中调用
+class EventLoop {
+public:
+    using EventCallback = std::function<void(epoll_event &)>;
+    using Functor = std::function<void()>;
+
+    EventLoop();
+    ~EventLoop();
+
+    // 禁用拷贝
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void loop();
+    void quit();
+
+    void setEventCallback(EventCallback callback);
+
+    // 跨线程投递任务，在循环线程中执行
+    void runInLoop(Functor task);
+    void queueInLoop(Functor task);
+    bool isInLoopThread() const;
+
+    // epoll 注册管理
+    bool addFd(int fd, uint32_t events);
+    bool modifyFd(int fd, uint32_t events);
+    bool removeFd(int fd);
+
+    // 定时器，epoll_wait 的超时取时间轮的下一次转动；回调在循环线程中执行
+    TimingWheel &timers();
+
+private:
+    static constexpr std::size_t MAX_EVENTS = 2048;
+
+    int epoll_fd_;
+    int wakeup_fd_;
+    std::atomic<bool> quit_;
+    // 循环线程，loop() 开始前为空，任何线程都不算循环线程
+    std::atomic<std::thread::id> thread_id_;
+    EventCallback event_callback_;
+    TimingWheel timers_;
+
+    std::mutex pending_mutex_;
+    std::vector<Functor> pending_tasks_;
+
+    void wakeup();
+    void handleWakeup();
+    void doPendingTasks();
+};
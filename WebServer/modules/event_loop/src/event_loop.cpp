@@ -0,0 +1,152 @@
+#include "event_loop.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+
+EventLoop::EventLoop()
+    : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+      wakeup_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      quit_(false),
+      thread_id_() {
+    if (epoll_fd_ < 0 || wakeup_fd_ < 0) {
+        if (epoll_fd_ >= 0) close(epoll_fd_);
+        if (wakeup_fd_ >= 0) close(wakeup_fd_);
+        LOG_FATAL("EventLoop creation failed: %s", strerror(errno));
+        throw std::runtime_error("EventLoop creation failed");
+    }
+
+    if (!addFd(wakeup_fd_, EPOLLIN)) {
+        close(epoll_fd_);
+        close(wakeup_fd_);
+        throw std::runtime_error("EventLoop wakeup registration failed");
+    }
+}
+
+EventLoop::~EventLoop() {
+    close(wakeup_fd_);
+    close(epoll_fd_);
+}
+
+void EventLoop::loop() {
+    // 进入 loop() 才认领归属线程；此前的 runInLoop 一律排队，留到循环开始后执行
+    thread_id_ = std::this_thread::get_id();
+    std::vector<epoll_event> events(MAX_EVENTS);
+
+    while (!quit_) {
+        int timeout = timers_.timeoutMillis(TimingWheel::Clock::now());
+        int event_count = epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, timeout);
+        if (event_count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+        // 先转动时间轮，事件回调中新挂的定时器从当前时间算起
+        timers_.advance(TimingWheel::Clock::now());
+
+        for (int i = 0; i < event_count; i++) {
+            if (events[i].data.fd == wakeup_fd_) {
+                handleWakeup();
+            } else if (event_callback_) {
+                event_callback_(events[i]);
+            }
+        }
+        doPendingTasks();
+    }
+}
+
+void EventLoop::quit() {
+    quit_ = true;
+    if (!isInLoopThread()) {
+        wakeup();
+    }
+}
+
+void EventLoop::setEventCallback(EventCallback callback) {
+    event_callback_ = std::move(callback);
+}
+
+void EventLoop::runInLoop(Functor task) {
+    if (isInLoopThread()) {
+        task();
+    } else {
+        queueInLoop(std::move(task));
+    }
+}
+
+void EventLoop::queueInLoop(Functor task) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_tasks_.push_back(std::move(task));
+    }
+    wakeup();
+}
+
+bool EventLoop::isInLoopThread() const {
+    return thread_id_.load() == std::this_thread::get_id();
+}
+
+TimingWheel &EventLoop::timers() {
+    return timers_;
+}
+
+bool EventLoop::addFd(int fd, uint32_t events) {
+    epoll_event event;
+    event.data.fd = fd;
+    event.events = events;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        LOG_ERROR("epoll_ctl add failed for fd %d: %s", fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::modifyFd(int fd, uint32_t events) {
+    epoll_event event;
+    event.data.fd = fd;
+    event.events = events;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) < 0) {
+        LOG_ERROR("Failed to modify epoll event for fd %d: %s", fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::removeFd(int fd) {
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) < 0) {
+        LOG_ERROR("Failed to remove fd %d from epoll: %s", fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    if (write(wakeup_fd_, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+        LOG_ERROR("EventLoop wakeup failed: %s", strerror(errno));
+    }
+}
+
+void EventLoop::handleWakeup() {
+    uint64_t count = 0;
+    if (read(wakeup_fd_, &count, sizeof(count)) != sizeof(count) && errno != EAGAIN) {
+        LOG_ERROR("EventLoop wakeup read failed: %s", strerror(errno));
+    }
+}
+
+void EventLoop::doPendingTasks() {
+    std::vector<Functor> tasks;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        tasks.swap(pending_tasks_);
+    }
+    for (auto &task : tasks) {
+        task();
+    }
+}
@@ -1,10 +1,35 @@
 #pragma once
 
 #include "http_request.h"
+#include <array>
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <queue>
 
+struct HttpHeaderView {
+    std::string_view key;
+    std::string_view value;
+};
+
+// 零拷贝请求视图：路径、查询串和头部都是指向输入缓冲区的 string_view，
+// 只在该缓冲区有效且未被修改期间可用
+struct HttpRequestView {
+    static constexpr size_t MAX_HEADERS = 64;
+
+    HttpMethod method = HttpMethod::GET;
+    HttpVersion version = HttpVersion::HTTP_1_1;
+    std::string_view path;
+    std::string_view query;
+    std::array<HttpHeaderView, MAX_HEADERS> headers;
+    size_t header_count = 0;
+    size_t header_length = 0;  // 请求行 + 头部 + 空行的字节数，即请求体的起始偏移
+
+    // 头部名大小写不敏感，不存在时返回空视图
+    std::string_view getHeader(std::string_view key) const;
+};
+
 class HttpParser {
 public:
     struct ParseResult {
@@ -12,6 +37,22 @@ public:
         size_t bytes_processed;
     };
 
+    // 请求头解析完成且带请求体时调用，返回非空 sink 时请求体按块流式交给它
+    using BodySinkFactory = std::function<std::unique_ptr<RequestBodySink>(const HttpRequest&)>;
+
+    enum class ViewStatus {
+        COMPLETE,
+        INCOMPLETE,
+        ERROR
+    };
+
+    // 当前未完成的请求读到哪一步，用于选择超时
+    enum class Progress {
+        IDLE,       // 没有未完成的请求 (出错后也不再读取)
+        HEADERS,    // 已收到请求的一部分，请求头还不完整
+        BODY        // 请求头已完成，正在接收请求体
+    };
+
     HttpParser();
     ~HttpParser() = default;
 
@@ -23,31 +64,68 @@ public:
     HttpParser(HttpParser&&) noexcept = default;
     HttpParser& operator=(HttpParser&&) noexcept = default;
 
+    // 请求体支持 Content-Length 和 Transfer-Encoding: chunked，两种方式解码后走同一条请求体路径
+    // 零拷贝模式：在调用方缓冲区上原地解析请求行和头部，不做任何堆分配
+    // 无状态，数据不完整时返回 INCOMPLETE，调用方补齐数据后从头重新解析
+    // 定界符扫描按 64 字节块做 SIMD 分类，运行时选择 AVX2 / SSE2 (非 x86 为标量) 实现
+    static ViewStatus parseView(const char* data, size_t len, HttpRequestView& view);
+    static const char* scannerImplementation();
+
+    // 解析器随连接常驻，跨多次读取保留未完成请求的状态
+    // 没有残留数据时直接在调用方缓冲区上解析，只把未消费的尾部拷贝进内部缓冲区
     ParseResult parse(const char* data, size_t len);
     bool hasCompletedRequest() const;
     HttpRequestPtr getCompletedRequest();
+    // 查看下一个已完成的请求但不取出，没有时返回 nullptr
+    const HttpRequest* peekCompletedRequest() const;
+    // 请求格式错误、头部超长或请求体无法交付 (落盘失败、sink 抛出异常)，连接应回复 400 后关闭
+    bool hasError() const;
+    Progress progress() const;
+
+    // 请求体按不超过 slice_size 的分片保存，0 表示保存为连续缓冲区 (默认)
+    void setBodySliceSize(size_t slice_size);
+    void setBodySinkFactory(BodySinkFactory factory);
+    // 未流式处理的请求体超过 threshold 字节时写入 directory 下的临时文件，0 表示不落盘
+    void setBodySpill(size_t threshold, std::string directory);
+
+    // 未完成的请求头允许缓存的上限
+    static constexpr size_t MAX_HEADER_SIZE = 64 * 1024;
+    // 按 Content-Length 预留请求体容量的上限，防止伪造的超大长度一次性占用内存
+    static constexpr size_t MAX_BODY_RESERVE = 64 * 1024 * 1024;
 
 private:
     enum class State {
-        METHOD,
-        URL,
-        VERSION,
-        HEADER_KEY,
-        HEADER_VALUE,
-        BODY,
-        FINISHED
+        HEADERS,
+        BODY,           // Content-Length 请求体
+        CHUNK_SIZE,     // chunked：块大小行 (可带扩展)
+        CHUNK_DATA,
+        CHUNK_END,      // 块数据后的 CRLF
+        TRAILERS,       // 最后一块之后的尾部字段，空行结束
+        ERROR
     };
 
     State state_;
     std::unique_ptr<HttpRequest> current_request_;
     std::queue<HttpRequestPtr> completed_requests_;
-    std::string current_header_key_;
     size_t content_length_;
+    bool chunked_;
+    size_t chunk_remaining_;
+    size_t trailer_size_;
+    size_t body_slice_size_;
+    BodySinkFactory body_sink_factory_;
+    size_t spill_threshold_;
+    std::string spill_directory_;
+    size_t header_scanned_;  // 当前请求头中已确认不含空行的字节数，避免逐字节到达时反复全量扫描
     std::string buffer_;
+    HttpRequestView view_;
 
+    void parseRequests(const char*& start, const char* end);
+    bool parseChunkSize(const char*& start, const char* end);
+    bool parseChunkEnd(const char*& start, const char* end);
+    bool parseTrailer(const char*& start, const char* end);
+    void appendBody(const char* data, size_t len, size_t remaining);
     void resetParserState();
-    void parseUrl(const std::string& url);
-    void trim(std::string& s);
+    bool startRequest(const HttpRequestView& view);
     void finalizeCurrentRequest();
 };
 
@@ -1,113 +1,375 @@
 #include "http_parser.h"
+#include "http_scanner.h"
 #include <algorithm>
-#include <cctype>
+#include <charconv>
+#include <cstring>
 
-HttpParser::HttpParser() 
-    : state_(State::METHOD), 
-      current_request_(std::make_unique<HttpRequest>()), 
-      content_length_(0) {}
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
 
-HttpParser::ParseResult HttpParser::parse(const char* data, size_t len) {
-    buffer_.append(data, len);
-    size_t total_processed = 0;
-
-    while (!buffer_.empty()) {
-        const char* start = buffer_.c_str();
-        const char* end = start + buffer_.length();
-        const char* current = start;
-
-        while (current < end) {
-            switch (state_) {
-                case State::METHOD:
-                    if (*current == ' ') {
-                        auto result = string_to_method(std::string(start, current));
-                        if (auto method = std::get_if<HttpMethod>(&result)) {
-                            current_request_->setMethod(*method);
-                            state_ = State::URL;
-                            start = current + 1;
-                        } else {
-                            // Handle error
-                            return {false, total_processed};
-                        }
-                    }
-                    break;
-                case State::URL:
-                    if (*current == ' ') {
-                        parseUrl(std::string(start, current));
-                        state_ = State::VERSION;
-                        start = current + 1;
-                    }
-                    break;
-                case State::VERSION:
-                    if (*current == '\r') {
-                        auto result = string_to_version(std::string(start, current));
-                        if (auto version = std::get_if<HttpVersion>(&result)) {
-                            current_request_->setVersion(*version);
-                        } else {
-                            // Handle error
-                            return {false, total_processed};
-                        }
-                    } else if (*current == '\n') {
-                        state_ = State::HEADER_KEY;
-                        start = current + 1;
-                    }
-                    break;
-                case State::HEADER_KEY:
-                    if (*current == ':') {
-                        current_header_key_ = std::string(start, current);
-                        state_ = State::HEADER_VALUE;
-                        start = current + 1;
-                    } else if (*current == '\r') {
-                        // Empty line, end of headers
-                    } else if (*current == '\n') {
-                        if (current_request_->hasHeader("Content-Length")) {
-                            content_length_ = std::stoul(current_request_->getHeader("Content-Length"));
-                            state_ = State::BODY;
-                        } else {
-                            finalizeCurrentRequest();
-                        }
-                        start = current + 1;
-                    }
-                    break;
-                case State::HEADER_VALUE:
-                    if (*current == '\r') {
-                        std::string value(start, current);
-                        trim(value);
-                        current_request_->setHeader(current_header_key_, value);
-                    } else if (*current == '\n') {
-                        state_ = State::HEADER_KEY;
-                        start = current + 1;
-                    }
-                    break;
-                case State::BODY:
-                    {
-                        size_t remaining = content_length_ - current_request_->getBody().length();
-                        size_t to_read = std::min(remaining, static_cast<size_t>(end - current));
-                        current_request_->setBody(current_request_->getBody() + std::string(current, to_read));
-                        current += to_read - 1; // -1 because the loop will increment current
-                        if (current_request_->getBody().length() == content_length_) {
-                            finalizeCurrentRequest();
-                        }
-                    }
-                    break;
-                case State::FINISHED:
-                    // This should not happen, as we reset the state after finalizing a request
-                    break;
+// 从 from 开始查找头部结束的空行，找到返回 true，否则把 from 推进到可以安全续扫的位置
+static bool findHeaderEnd(const char* data, size_t len, size_t& from) {
+    const char* end = data + len;
+    const char* p = data + from;
+    while (p < end) {
+        auto eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) {
+            break;
+        }
+        const char* next = eol + 1;
+        if (next < end && *next == '\r') {
+            ++next;
+        }
+        if (next < end && *next == '\n') {
+            return true;
+        }
+        if (next >= end) {
+            // 换行出现在末尾，下次要从这个换行处重新判断
+            from = eol - data;
+            return false;
+        }
+        p = eol + 1;
+    }
+    from = len;
+    return false;
+}
+
+std::string_view HttpRequestView::getHeader(std::string_view key) const {
+    for (size_t i = 0; i < header_count; ++i) {
+        if (equals_ignore_case(headers[i].key, key)) {
+            return headers[i].value;
+        }
+    }
+    return {};
+}
+
+HttpParser::HttpParser()
+    : state_(State::HEADERS),
+      current_request_(std::make_unique<HttpRequest>()),
+      content_length_(0),
+      chunked_(false),
+      chunk_remaining_(0),
+      trailer_size_(0),
+      body_slice_size_(0),
+      spill_threshold_(0),
+      header_scanned_(0) {}
+
+// 去掉行尾 LF 前的 CR
+static const char* lineContentEnd(const char* line, const char* newline) {
+    return (newline > line && newline[-1] == '\r') ? newline - 1 : newline;
+}
+
+template<typename Scanner>
+static HttpParser::ViewStatus parseViewWith(const char* data, size_t len, HttpRequestView& view) {
+    using ViewStatus = HttpParser::ViewStatus;
+    using namespace http_scanner;
+
+    const char* end = data + len;
+    Structurals<Scanner> structurals(data, len);
+
+    // 请求行：METHOD SP request-target SP HTTP-version，请求目标中可能有冒号
+    const char* newline = structurals.next();
+    while (newline != end && *newline != '\n') {
+        newline = structurals.next();
+    }
+    if (newline == end) {
+        return ViewStatus::INCOMPLETE;
+    }
+    const char* line_end = lineContentEnd(data, newline);
+    auto method_end = static_cast<const char*>(std::memchr(data, ' ', line_end - data));
+    auto target_end = method_end ? static_cast<const char*>(std::memchr(method_end + 1, ' ', line_end - method_end - 1))
+                                 : nullptr;
+    if (!target_end || method_end == data || target_end == method_end + 1) {
+        return ViewStatus::ERROR;
+    }
+
+    auto method = string_to_method(std::string_view(data, method_end - data));
+    auto version = string_to_version(std::string_view(target_end + 1, line_end - target_end - 1));
+    if (!std::holds_alternative<HttpMethod>(method) || !std::holds_alternative<HttpVersion>(version)) {
+        return ViewStatus::ERROR;
+    }
+    view.method = std::get<HttpMethod>(method);
+    view.version = std::get<HttpVersion>(version);
+
+    std::string_view target(method_end + 1, target_end - method_end - 1);
+    size_t question = target.find('?');
+    view.path = target.substr(0, question);
+    view.query = (question == std::string_view::npos) ? std::string_view() : target.substr(question + 1);
+
+    // 头部：逐行解析到空行为止
+    view.header_count = 0;
+    const char* p = newline + 1;
+    while (true) {
+        if (p == end) {
+            return ViewStatus::INCOMPLETE;
+        }
+        if (*p == '\r' || *p == '\n') {
+            newline = (*p == '\r') ? p + 1 : p;
+            if (newline == end) {
+                return ViewStatus::INCOMPLETE;
             }
-            ++current;
+            // 空行之前的所有块都已遍历过，一次性校验控制字符和孤立的 CR
+            if (*newline != '\n' || structurals.firstInvalid() < newline) {
+                return ViewStatus::ERROR;
+            }
+            view.header_length = newline + 1 - data;
+            return ViewStatus::COMPLETE;
         }
 
-        size_t processed = current - start;
-        total_processed += processed;
-        buffer_ = buffer_.substr(processed);
+        // 头部名在第一个冒号处结束，冒号前不允许有空白
+        const char* colon = structurals.next();
+        if (colon == end) {
+            return ViewStatus::INCOMPLETE;
+        }
+        if (*colon != ':' || colon == p || colon[-1] == ' ' || colon[-1] == '\t' ||
+            view.header_count == HttpRequestView::MAX_HEADERS) {
+            return ViewStatus::ERROR;
+        }
+        // 值里的冒号 (端口、URL) 直接跳过
+        newline = structurals.next();
+        while (newline != end && *newline != '\n') {
+            newline = structurals.next();
+        }
+        if (newline == end) {
+            return ViewStatus::INCOMPLETE;
+        }
+        line_end = lineContentEnd(colon + 1, newline);
+        view.headers[view.header_count++] = {
+            std::string_view(p, colon - p),
+            trim_ows(std::string_view(colon + 1, line_end - colon - 1))
+        };
+        p = newline + 1;
+    }
+}
 
-        if (state_ != State::FINISHED) {
-            // We need more data to complete the current request
-            break;
+// 每种指令集一份完整的 parseView 实例，flatten 把分类和遍历全部内联进来
+#ifdef HTTP_SCANNER_X86
+__attribute__((target("avx2"), flatten))
+static HttpParser::ViewStatus parseViewAvx2(const char* data, size_t len, HttpRequestView& view) {
+    return parseViewWith<http_scanner::Avx2Scanner>(data, len, view);
+}
+
+__attribute__((flatten))
+static HttpParser::ViewStatus parseViewSse2(const char* data, size_t len, HttpRequestView& view) {
+    return parseViewWith<http_scanner::Sse2Scanner>(data, len, view);
+}
+#else
+static HttpParser::ViewStatus parseViewScalar(const char* data, size_t len, HttpRequestView& view) {
+    return parseViewWith<http_scanner::ScalarScanner>(data, len, view);
+}
+#endif
+
+struct ParseViewImpl {
+    const char* name;
+    HttpParser::ViewStatus (*parse)(const char* data, size_t len, HttpRequestView& view);
+};
+
+static ParseViewImpl selectParseView() {
+#ifdef HTTP_SCANNER_X86
+    if (http_scanner::hasAvx2()) {
+        return {http_scanner::Avx2Scanner::NAME, parseViewAvx2};
+    }
+    return {http_scanner::Sse2Scanner::NAME, parseViewSse2};
+#else
+    return {http_scanner::ScalarScanner::NAME, parseViewScalar};
+#endif
+}
+
+static const ParseViewImpl parseViewImpl = selectParseView();
+
+HttpParser::ViewStatus HttpParser::parseView(const char* data, size_t len, HttpRequestView& view) {
+    return parseViewImpl.parse(data, len, view);
+}
+
+HttpParser::ParseResult HttpParser::parse(const char* data, size_t len) {
+    if (state_ == State::ERROR) {
+        return {false, 0};
+    }
+
+    // 上次没有残留时直接解析调用方的数据，省去一次拷贝
+    bool buffered = !buffer_.empty();
+    if (buffered) {
+        buffer_.append(data, len);
+        data = buffer_.data();
+        len = buffer_.length();
+    }
+
+    const char* start = data;
+    const char* end = data + len;
+
+    try {
+        parseRequests(start, end);
+    } catch (const std::exception&) {
+        // 落盘失败或流式 sink 抛出异常，当前请求无法继续交付
+        state_ = State::ERROR;
+    }
+
+    // 只保留未消费的部分，不完整的请求头留到下次继续解析；erase/assign 复用已有容量
+    size_t processed = start - data;
+    if (buffered) {
+        buffer_.erase(0, processed);
+    } else {
+        buffer_.assign(start, end);
+    }
+    if (buffer_.length() > MAX_HEADER_SIZE) {
+        state_ = State::ERROR;
+    }
+
+    return {!completed_requests_.empty(), processed};
+}
+
+void HttpParser::parseRequests(const char*& start, const char* end) {
+    bool progress = true;
+    while (progress && start < end && state_ != State::ERROR) {
+        switch (state_) {
+            case State::HEADERS: {
+                if (!findHeaderEnd(start, end - start, header_scanned_)) {
+                    return;
+                }
+                ViewStatus status = parseView(start, end - start, view_);
+                if (status == ViewStatus::INCOMPLETE) {
+                    return;
+                }
+                if (status == ViewStatus::ERROR || !startRequest(view_)) {
+                    state_ = State::ERROR;
+                    return;
+                }
+                start += view_.header_length;
+                if (chunked_) {
+                    state_ = State::CHUNK_SIZE;
+                } else if (content_length_ == 0) {
+                    finalizeCurrentRequest();
+                } else {
+                    state_ = State::BODY;
+                }
+                break;
+            }
+            case State::BODY: {
+                size_t remaining = content_length_ - current_request_->getBodyLength();
+                size_t to_read = std::min(remaining, static_cast<size_t>(end - start));
+                appendBody(start, to_read, remaining);
+                start += to_read;
+                if (current_request_->getBodyLength() == content_length_) {
+                    finalizeCurrentRequest();
+                }
+                break;
+            }
+            case State::CHUNK_SIZE:
+                progress = parseChunkSize(start, end);
+                break;
+            case State::CHUNK_DATA: {
+                size_t to_read = std::min(chunk_remaining_, static_cast<size_t>(end - start));
+                appendBody(start, to_read, chunk_remaining_);
+                start += to_read;
+                chunk_remaining_ -= to_read;
+                if (chunk_remaining_ == 0) {
+                    state_ = State::CHUNK_END;
+                }
+                break;
+            }
+            case State::CHUNK_END:
+                progress = parseChunkEnd(start, end);
+                break;
+            case State::TRAILERS:
+                progress = parseTrailer(start, end);
+                break;
+            case State::ERROR:
+                return;
         }
     }
+}
 
-    return {!completed_requests_.empty(), total_processed};
+bool HttpParser::parseChunkSize(const char*& start, const char* end) {
+    auto eol = static_cast<const char*>(std::memchr(start, '\n', end - start));
+    if (!eol) {
+        return false;
+    }
+    const char* line_end = lineContentEnd(start, eol);
+    const char* p = start;
+    size_t size = 0;
+    for (; p < line_end && hexValue(*p) >= 0; ++p) {
+        if (size > (SIZE_MAX >> 4)) {
+            state_ = State::ERROR;
+            return false;
+        }
+        size = (size << 4) | hexValue(*p);
+    }
+    // 块扩展 (;name=value) 不影响解码，直接忽略
+    const char* rest = p;
+    while (rest < line_end && (*rest == ' ' || *rest == '\t')) {
+        ++rest;
+    }
+    if (p == start || (rest < line_end && *rest != ';')) {
+        state_ = State::ERROR;
+        return false;
+    }
+    start = eol + 1;
+    chunk_remaining_ = size;
+    state_ = (size == 0) ? State::TRAILERS : State::CHUNK_DATA;
+    return true;
+}
+
+bool HttpParser::parseChunkEnd(const char*& start, const char* end) {
+    if (*start == '\n') {
+        ++start;
+    } else if (*start != '\r') {
+        state_ = State::ERROR;
+        return false;
+    } else if (end - start < 2) {
+        return false;
+    } else if (start[1] != '\n') {
+        state_ = State::ERROR;
+        return false;
+    } else {
+        start += 2;
+    }
+    state_ = State::CHUNK_SIZE;
+    return true;
+}
+
+bool HttpParser::parseTrailer(const char*& start, const char* end) {
+    auto eol = static_cast<const char*>(std::memchr(start, '\n', end - start));
+    if (!eol) {
+        return false;
+    }
+    const char* line_end = lineContentEnd(start, eol);
+    trailer_size_ += eol + 1 - start;
+    if (line_end == start) {
+        start = eol + 1;
+        finalizeCurrentRequest();
+        return true;
+    }
+
+    auto colon = static_cast<const char*>(std::memchr(start, ':', line_end - start));
+    if (!colon || colon == start || trailer_size_ > MAX_HEADER_SIZE) {
+        state_ = State::ERROR;
+        return false;
+    }
+    // 尾部字段不能覆盖请求头中已有的字段 (例如 Content-Length)
+    std::string name(start, colon - start);
+    if (!current_request_->hasHeader(name)) {
+        current_request_->setHeader(name, trim_ows(std::string_view(colon + 1, line_end - colon - 1)));
+    }
+    start = eol + 1;
+    return true;
+}
+
+void HttpParser::appendBody(const char* data, size_t len, size_t remaining) {
+    HttpRequest& request = *current_request_;
+    // chunked 请求体事先不知道长度，累积超过阈值时再转为落盘
+    if (spill_threshold_ > 0 && !request.getBodySink() && !request.isBodySpilled() &&
+        request.getBodyLength() + len > spill_threshold_) {
+        request.spillBody(spill_directory_);
+    }
+    if (body_slice_size_ == 0 || request.getBodySink() || request.isBodySpilled()) {
+        request.appendBody(data, len);
+    } else {
+        request.appendBodySlice(data, len, body_slice_size_, remaining);
+    }
 }
 
 bool HttpParser::hasCompletedRequest() const {
@@ -123,30 +385,116 @@ HttpRequestPtr HttpParser::getCompletedRequest() {
     return request;
 }
 
+const HttpRequest* HttpParser::peekCompletedRequest() const {
+    return completed_requests_.empty() ? nullptr : completed_requests_.front().get();
+}
+
+const char* HttpParser::scannerImplementation() {
+    return parseViewImpl.name;
+}
+
+void HttpParser::setBodySliceSize(size_t slice_size) {
+    body_slice_size_ = slice_size;
+}
+
+void HttpParser::setBodySinkFactory(BodySinkFactory factory) {
+    body_sink_factory_ = std::move(factory);
+}
+
+void HttpParser::setBodySpill(size_t threshold, std::string directory) {
+    spill_threshold_ = threshold;
+    spill_directory_ = std::move(directory);
+}
+
+bool HttpParser::hasError() const {
+    return state_ == State::ERROR;
+}
+
+HttpParser::Progress HttpParser::progress() const {
+    switch (state_) {
+        case State::HEADERS:
+            return buffer_.empty() ? Progress::IDLE : Progress::HEADERS;
+        case State::ERROR:
+            return Progress::IDLE;
+        default:
+            return Progress::BODY;
+    }
+}
+
 void HttpParser::resetParserState() {
-    state_ = State::METHOD;
+    state_ = State::HEADERS;
     current_request_ = std::make_unique<HttpRequest>();
-    current_header_key_.clear();
     content_length_ = 0;
+    chunked_ = false;
+    chunk_remaining_ = 0;
+    trailer_size_ = 0;
+    header_scanned_ = 0;
 }
 
-void HttpParser::parseUrl(const std::string& url) {
-    auto pos = url.find('?');
-    if (pos != std::string::npos) {
-        current_request_->setPath(url.substr(0, pos));
-        current_request_->setQuery(url.substr(pos + 1));
-    } else {
-        current_request_->setPath(url);
+bool HttpParser::startRequest(const HttpRequestView& view) {
+    // 把视图物化为 HttpRequest，供路由和处理器在缓冲区失效后继续使用
+    current_request_->setMethod(view.method);
+    current_request_->setVersion(view.version);
+    current_request_->setPath(view.path);
+    if (!view.query.empty()) {
+        current_request_->setQuery(view.query);
+    }
+    for (size_t i = 0; i < view.header_count; ++i) {
+        current_request_->setHeader(view.headers[i].key, view.headers[i].value);
+    }
+
+    // 请求的分帧必须无歧义：重复的 Content-Length 取值必须相同，Transfer-Encoding (包括多个同名头部)
+    // 合起来只能是单独一个 chunked；同时带两者是请求走私的典型手法，直接拒绝
+    std::string_view length;
+    size_t encodings = 0;
+    bool has_length = false;
+    for (size_t i = 0; i < view.header_count; ++i) {
+        const HttpHeaderView& header = view.headers[i];
+        if (equals_ignore_case(header.key, "Content-Length")) {
+            if (has_length && header.value != length) {
+                return false;
+            }
+            has_length = true;
+            length = header.value;
+        } else if (equals_ignore_case(header.key, "Transfer-Encoding")) {
+            encodings++;
+            if (encodings > 1 || !equals_ignore_case(header.value, "chunked")) {
+                return false;
+            }
+        }
+    }
+    if (encodings > 0) {
+        if (has_length) {
+            return false;
+        }
+        chunked_ = true;
+    } else if (has_length) {
+        auto [ptr, ec] = std::from_chars(length.data(), length.data() + length.size(), content_length_);
+        if (ec != std::errc() || ptr != length.data() + length.size()) {
+            return false;
+        }
+    }
+    if (!chunked_ && content_length_ == 0) {
+        return true;
     }
-}
 
-void HttpParser::trim(std::string& s) {
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }));
-    s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }).base(), s.end());
+    // 流式路由优先；否则超过阈值的请求体落盘，其余按 Content-Length 预留内存
+    // chunked 请求体的长度事先未知，是否落盘在累积过程中决定
+    if (body_sink_factory_) {
+        current_request_->setBodySink(body_sink_factory_(*current_request_));
+    }
+    if (current_request_->getBodySink()) {
+        return true;
+    }
+    if (chunked_) {
+        return true;
+    }
+    if (spill_threshold_ > 0 && content_length_ > spill_threshold_) {
+        current_request_->spillBody(spill_directory_);
+    } else if (body_slice_size_ == 0) {
+        current_request_->reserveBody(std::min(content_length_, MAX_BODY_RESERVE));
+    }
+    return true;
 }
 
 void HttpParser::finalizeCurrentRequest() {
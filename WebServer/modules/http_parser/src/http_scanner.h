@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 请求头结构字符扫描，思路同 picohttpparser / simdjson：
+// 每 64 字节一块，用 SIMD 一次算出 LF、CR、冒号和非法控制字符的位图，
+// 解析时按顺序用 tzcnt 取出 LF / 冒号的位置，不再逐字节比较
+// 每种指令集一个 Scanner，parseView 按 Scanner 分别实例化，运行时通过 CPUID 只分派一次
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_SCANNER_X86 1
+#endif
+
+namespace http_scanner {
+
+constexpr size_t BLOCK_SIZE = 64;
+
+struct BlockMasks {
+    uint64_t newline;
+    uint64_t cr;
+    uint64_t colon;
+    uint64_t ctl;  // \t \r \n 以外的控制字符和 DEL
+};
+
+struct ScalarScanner {
+    static constexpr const char* NAME = "scalar";
+
+    static BlockMasks classify(const char* p) {
+        BlockMasks masks{};
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+            auto c = static_cast<unsigned char>(p[i]);
+            uint64_t bit = uint64_t(1) << i;
+            if (c == '\n') masks.newline |= bit;
+            else if (c == '\r') masks.cr |= bit;
+            else if (c == ':') masks.colon |= bit;
+            else if ((c < 0x20 && c != '\t') || c == 0x7f) masks.ctl |= bit;
+        }
+        return masks;
+    }
+};
+
+#ifdef HTTP_SCANNER_X86
+
+inline bool hasAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+// 16 字节一组，只用 x86-64 基线的 SSE2 指令，任何 x86-64 CPU 都可用
+struct Sse2Scanner {
+    static constexpr const char* NAME = "sse2";
+
+    static uint64_t movemask(__m128i a, __m128i b, __m128i c, __m128i d) {
+        return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(a))) |
+               static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(b))) << 16 |
+               static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(c))) << 32 |
+               static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(d))) << 48;
+    }
+
+    // 无符号 x <= 0x1f 等价于 min(x, 0x1f) == x
+    static __m128i control(__m128i x) {
+        __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(0x1f)), x);
+        return _mm_or_si128(low, _mm_cmpeq_epi8(x, _mm_set1_epi8(0x7f)));
+    }
+
+    static BlockMasks classify(const char* p) {
+        __m128i x[4];
+        for (int i = 0; i < 4; ++i) {
+            x[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        }
+        __m128i newline[4], cr[4], colon[4], ctl[4];
+        for (int i = 0; i < 4; ++i) {
+            newline[i] = _mm_cmpeq_epi8(x[i], _mm_set1_epi8('\n'));
+            cr[i] = _mm_cmpeq_epi8(x[i], _mm_set1_epi8('\r'));
+            colon[i] = _mm_cmpeq_epi8(x[i], _mm_set1_epi8(':'));
+            __m128i allowed = _mm_or_si128(_mm_or_si128(newline[i], cr[i]),
+                                           _mm_cmpeq_epi8(x[i], _mm_set1_epi8('\t')));
+            ctl[i] = _mm_andnot_si128(allowed, control(x[i]));
+        }
+        BlockMasks masks;
+        masks.newline = movemask(newline[0], newline[1], newline[2], newline[3]);
+        masks.cr = movemask(cr[0], cr[1], cr[2], cr[3]);
+        masks.colon = movemask(colon[0], colon[1], colon[2], colon[3]);
+        masks.ctl = movemask(ctl[0], ctl[1], ctl[2], ctl[3]);
+        return masks;
+    }
+};
+
+// 32 字节一组
+struct Avx2Scanner {
+    static constexpr const char* NAME = "avx2";
+
+    __attribute__((target("avx2")))
+    static uint64_t movemask(__m256i lo, __m256i hi) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(lo))) |
+               static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hi))) << 32;
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i control(__m256i x) {
+        __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(0x1f)), x);
+        return _mm256_or_si256(low, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x7f)));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i match(__m256i x, char c) {
+        return _mm256_cmpeq_epi8(x, _mm256_set1_epi8(c));
+    }
+
+    __attribute__((target("avx2")))
+    static BlockMasks classify(const char* p) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        __m256i newline_lo = match(lo, '\n'), newline_hi = match(hi, '\n');
+        __m256i cr_lo = match(lo, '\r'), cr_hi = match(hi, '\r');
+        __m256i allowed_lo = _mm256_or_si256(_mm256_or_si256(newline_lo, cr_lo), match(lo, '\t'));
+        __m256i allowed_hi = _mm256_or_si256(_mm256_or_si256(newline_hi, cr_hi), match(hi, '\t'));
+        BlockMasks masks;
+        masks.newline = movemask(newline_lo, newline_hi);
+        masks.cr = movemask(cr_lo, cr_hi);
+        masks.colon = movemask(match(lo, ':'), match(hi, ':'));
+        masks.ctl = movemask(_mm256_andnot_si256(allowed_lo, control(lo)),
+                                 _mm256_andnot_si256(allowed_hi, control(hi)));
+        return masks;
+    }
+};
+
+#endif
+
+// 按顺序遍历 LF 和冒号的位置，同 simdjson 的结构字符索引；每块只分类一次，
+// 取下一个位置只需 tzcnt 和清最低位，没有逐字节的依赖链
+// 同时记录第一个非法字节 (控制字符或不在 LF 前的 CR) 的位置，供解析结束时统一校验
+template<typename Scanner>
+class Structurals {
+public:
+    Structurals(const char* data, size_t len)
+        : data_(data), len_(len), next_block_(0), bits_(0), first_invalid_(len) {}
+
+    // 返回下一个 LF 或冒号的位置，数据用完时返回 data + len
+    const char* next() {
+        while (bits_ == 0) {
+            if (next_block_ >= len_) {
+                return data_ + len_;
+            }
+            load();
+        }
+        const char* position = block_ + __builtin_ctzll(bits_);
+        bits_ &= bits_ - 1;
+        return position;
+    }
+
+    // 已经遍历过的块中第一个非法字节，调用方保证要校验的范围已经全部遍历过
+    const char* firstInvalid() const {
+        return data_ + first_invalid_;
+    }
+
+private:
+    const char* data_;
+    size_t len_;
+    size_t next_block_;
+    const char* block_;
+    uint64_t bits_;
+    size_t first_invalid_;
+
+    void load() {
+        size_t start = next_block_;
+        size_t count = len_ - start;
+        BlockMasks masks;
+        if (count >= BLOCK_SIZE) {
+            masks = Scanner::classify(data_ + start);
+        } else {
+            // 最后不足一块的数据拷到补零的临时块中，块外的位清零
+            alignas(32) char tail[BLOCK_SIZE] = {};
+            std::memcpy(tail, data_ + start, count);
+            masks = Scanner::classify(tail);
+            uint64_t valid = (uint64_t(1) << count) - 1;
+            masks.newline &= valid;
+            masks.cr &= valid;
+            masks.colon &= valid;
+            masks.ctl &= valid;
+        }
+        block_ = data_ + start;
+        next_block_ = start + BLOCK_SIZE;
+        bits_ = masks.newline | masks.colon;
+
+        // CR 只能紧跟在 LF 前；块尾的 CR 要看下一块的第一个字节
+        uint64_t invalid = masks.ctl | (masks.cr & ~(masks.newline >> 1) & ~(uint64_t(1) << 63));
+        if ((masks.cr >> 63) && next_block_ < len_ && data_[next_block_] != '\n') {
+            invalid |= uint64_t(1) << 63;
+        }
+        if (invalid != 0 && first_invalid_ == len_) {
+            first_invalid_ = start + __builtin_ctzll(invalid);
+        }
+    }
+};
+
+} // namespace http_scanner
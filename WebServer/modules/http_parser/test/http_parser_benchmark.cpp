@@ -0,0 +1,70 @@
+#include "http_parser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// 典型浏览器请求头（约 600 字节）
+static const std::string kBrowserRequest =
+    "GET /css/index.css?v=1.0.3 HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", \"Not-A.Brand\";v=\"99\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+    "Chrome/124.0.0.0 Safari/537.36\r\n"
+    "sec-ch-ua-platform: \"Linux\"\r\n"
+    "Accept: text/css,*/*;q=0.1\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Dest: style\r\n"
+    "Referer: https://www.example.com/index.html\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: en-US,en;q=0.9,zh-CN;q=0.8,zh;q=0.7\r\n"
+    "Cookie: session=7f3a9c2e1b; theme=dark\r\n"
+    "\r\n";
+
+template<typename Fn>
+static void run(const char* name, size_t iterations, Fn&& fn) {
+    auto begin = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        checksum += fn();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    double bytes = static_cast<double>(kBrowserRequest.size()) * iterations;
+    std::printf("%-28s %8.3f GB/s  %10.0f req/s  (checksum %zu)\n",
+                name, bytes / elapsed.count() / 1e9, iterations / elapsed.count(), checksum);
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    std::printf("request size: %zu bytes, iterations: %zu, scanner: %s\n",
+                kBrowserRequest.size(), iterations, HttpParser::scannerImplementation());
+
+    HttpRequestView view;
+    run("parseView (zero-copy)", iterations, [&] {
+        HttpParser::parseView(kBrowserRequest.data(), kBrowserRequest.size(), view);
+        return view.header_count;
+    });
+
+    HttpParser parser;
+    run("parse (HttpRequest)", iterations / 4, [&] {
+        parser.parse(kBrowserRequest.data(), kBrowserRequest.size());
+        return parser.getCompletedRequest()->getHeaders().size();
+    });
+
+    // 50 MB 上传按 64 KB 分次读入，请求体应当线性累积
+    std::string body(50 * 1024 * 1024, 'x');
+    std::string upload = "POST /upload HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                         "\r\n\r\n" + body;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < upload.size(); sent += 64 * 1024) {
+        parser.parse(upload.data() + sent, std::min<size_t>(64 * 1024, upload.size() - sent));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    std::printf("%-28s %8.3f GB/s  (body %zu bytes)\n", "parse (50 MB body)",
+                upload.size() / elapsed.count() / 1e9, parser.getCompletedRequest()->getBodyLength());
+    return 0;
+}
@@ -0,0 +1,389 @@
+#include <gtest/gtest.h>
+#include "http_parser.h"
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+static const std::string kRequest =
+    "GET /index.html?lang=en HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: Mozilla/5.0\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+static const std::string kPostRequest =
+    "POST /login HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "Content-Length: 11\r\n"
+    "\r\n"
+    "user=a&pw=b";
+
+static void expectGetRequest(const HttpRequest &request) {
+    EXPECT_EQ(request.getMethod(), HttpMethod::GET);
+    EXPECT_EQ(request.getPath(), "/index.html");
+    EXPECT_EQ(request.getQuery(), "lang=en");
+    EXPECT_EQ(request.getVersion(), HttpVersion::HTTP_1_1);
+    EXPECT_EQ(request.getHeader("Host"), "localhost:8080");
+    EXPECT_EQ(request.getHeader("Connection"), "keep-alive");
+}
+
+TEST(HttpParserTest, ParsesCompleteRequest) {
+    HttpParser parser;
+    parser.parse(kRequest.data(), kRequest.size());
+
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    expectGetRequest(*parser.getCompletedRequest());
+    EXPECT_FALSE(parser.hasCompletedRequest());
+    EXPECT_FALSE(parser.hasError());
+}
+
+TEST(HttpParserTest, LooksUpHeadersCaseInsensitively) {
+    HttpParser parser;
+    std::string stream = "GET / HTTP/1.1\r\nhost: x\r\nconnection: close\r\nIF-NONE-MATCH: \"v1\"\r\n\r\n";
+    parser.parse(stream.data(), stream.size());
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    auto request = parser.getCompletedRequest();
+    EXPECT_EQ(request->getHeader("Connection"), "close");
+    EXPECT_TRUE(request->hasHeader("If-None-Match"));
+    EXPECT_EQ(request->getHeader("if-none-match"), "\"v1\"");
+}
+
+TEST(HttpParserTest, ResumesAcrossEverySplitPoint) {
+    for (size_t split = 1; split < kRequest.size(); ++split) {
+        HttpParser parser;
+        parser.parse(kRequest.data(), split);
+        EXPECT_FALSE(parser.hasCompletedRequest()) << "split at " << split;
+        parser.parse(kRequest.data() + split, kRequest.size() - split);
+
+        ASSERT_TRUE(parser.hasCompletedRequest()) << "split at " << split;
+        expectGetRequest(*parser.getCompletedRequest());
+    }
+}
+
+TEST(HttpParserTest, ResumesByteByByte) {
+    HttpParser parser;
+    std::string stream = kRequest + kPostRequest;
+    for (char c : stream) {
+        parser.parse(&c, 1);
+    }
+
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    expectGetRequest(*parser.getCompletedRequest());
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    auto post = parser.getCompletedRequest();
+    EXPECT_EQ(post->getMethod(), HttpMethod::POST);
+    EXPECT_EQ(post->getBody(), "user=a&pw=b");
+}
+
+TEST(HttpParserTest, ParsesPipelinedRequests) {
+    HttpParser parser;
+    std::string stream = kRequest + kPostRequest + kRequest;
+    parser.parse(stream.data(), stream.size());
+
+    std::vector<HttpMethod> methods;
+    while (const HttpRequest* next = parser.peekCompletedRequest()) {
+        auto request = parser.getCompletedRequest();
+        EXPECT_EQ(next, request.get());
+        methods.push_back(request->getMethod());
+    }
+    EXPECT_EQ(methods, (std::vector<HttpMethod>{HttpMethod::GET, HttpMethod::POST, HttpMethod::GET}));
+    EXPECT_FALSE(parser.hasCompletedRequest());
+}
+
+TEST(HttpParserTest, ReportsProgressOfPartialRequest) {
+    HttpParser parser;
+    EXPECT_EQ(parser.progress(), HttpParser::Progress::IDLE);
+    size_t header_end = kPostRequest.find("\r\n\r\n") + 4;
+    parser.parse(kPostRequest.data(), 10);
+    EXPECT_EQ(parser.progress(), HttpParser::Progress::HEADERS);
+    parser.parse(kPostRequest.data() + 10, header_end - 10);
+    EXPECT_EQ(parser.progress(), HttpParser::Progress::BODY);
+    parser.parse(kPostRequest.data() + header_end, kPostRequest.size() - header_end);
+    EXPECT_EQ(parser.progress(), HttpParser::Progress::IDLE);
+    EXPECT_TRUE(parser.hasCompletedRequest());
+}
+
+TEST(HttpParserTest, AccumulatesLargeBodyAcrossReads) {
+    std::string body(1 << 20, 'x');
+    for (size_t i = 0; i < body.size(); ++i) {
+        body[i] = static_cast<char>('a' + i % 26);
+    }
+    std::string request = "POST /upload HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                          "\r\n\r\n" + body;
+
+    for (size_t slice_size : {size_t(0), size_t(100000)}) {
+        HttpParser parser;
+        parser.setBodySliceSize(slice_size);
+        for (size_t sent = 0; sent < request.size(); sent += 4096) {
+            parser.parse(request.data() + sent, std::min<size_t>(4096, request.size() - sent));
+        }
+
+        ASSERT_TRUE(parser.hasCompletedRequest()) << "slice size " << slice_size;
+        auto post = parser.getCompletedRequest();
+        EXPECT_EQ(post->getBodyLength(), body.size());
+        if (slice_size == 0) {
+            EXPECT_TRUE(post->getBodySlices().empty());
+        } else {
+            EXPECT_EQ(post->getBodySlices().size(), (body.size() + slice_size - 1) / slice_size);
+            EXPECT_EQ(post->getBodySlices().front().size(), slice_size);
+        }
+        EXPECT_EQ(post->getBody(), body);
+    }
+}
+
+namespace {
+
+class CollectingSink : public RequestBodySink {
+public:
+    explicit CollectingSink(std::string& out) : out_(out) {}
+    void onBodyData(const char* data, size_t len) override {
+        out_.append(data, len);
+        ++calls;
+    }
+    int calls = 0;
+
+private:
+    std::string& out_;
+};
+
+} // namespace
+
+TEST(HttpParserTest, StreamsBodyToSink) {
+    std::string received;
+    HttpParser parser;
+    parser.setBodySinkFactory([&](const HttpRequest& request) -> std::unique_ptr<RequestBodySink> {
+        if (request.getPath() != "/login") {
+            return nullptr;
+        }
+        return std::make_unique<CollectingSink>(received);
+    });
+
+    std::string stream = kPostRequest + kRequest;
+    for (char c : stream) {
+        parser.parse(&c, 1);
+    }
+
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    auto post = parser.getCompletedRequest();
+    EXPECT_EQ(received, "user=a&pw=b");
+    EXPECT_EQ(post->getBodyLength(), received.size());
+    EXPECT_TRUE(post->getBody().empty());
+    ASSERT_NE(post->getBodySink(), nullptr);
+    EXPECT_EQ(static_cast<CollectingSink*>(post->getBodySink())->calls, 11);
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    expectGetRequest(*parser.getCompletedRequest());
+}
+
+TEST(HttpParserTest, SpillsLargeBodyToFile) {
+    HttpParser parser;
+    parser.setBodySpill(4, "/tmp");
+    std::string stream = kPostRequest + kPostRequest;
+    parser.parse(stream.data(), stream.size());
+
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    auto post = parser.getCompletedRequest();
+    ASSERT_TRUE(post->isBodySpilled());
+    char data[32] = {};
+    EXPECT_EQ(pread(post->getBodyFd(), data, sizeof(data), 0), 11);
+    EXPECT_EQ(std::string(data), "user=a&pw=b");
+    EXPECT_EQ(post->getBody(), "user=a&pw=b");
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    EXPECT_TRUE(parser.getCompletedRequest()->isBodySpilled());
+}
+
+TEST(HttpParserTest, RejectsBodyWhenSpillFails) {
+    HttpParser parser;
+    parser.setBodySpill(4, "/nonexistent-spill-directory");
+    parser.parse(kPostRequest.data(), kPostRequest.size());
+
+    EXPECT_TRUE(parser.hasError());
+    EXPECT_FALSE(parser.hasCompletedRequest());
+}
+
+static const std::string kChunkedRequest =
+    "POST /upload HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "\r\n"
+    "5;name=value\r\n"
+    "hello\r\n"
+    "7\r\n"
+    ", world\r\n"
+    "0\r\n"
+    "X-Checksum: abc\r\n"
+    "Host: ignored\r\n"
+    "\r\n";
+
+static void expectChunkedRequest(const HttpRequest &request) {
+    EXPECT_EQ(request.getMethod(), HttpMethod::POST);
+    EXPECT_EQ(request.getBody(), "hello, world");
+    EXPECT_EQ(request.getHeader("X-Checksum"), "abc");
+    EXPECT_EQ(request.getHeader("Host"), "localhost");
+}
+
+TEST(HttpParserTest, DecodesChunkedBody) {
+    HttpParser parser;
+    std::string stream = kChunkedRequest + kRequest;
+    parser.parse(stream.data(), stream.size());
+
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    expectChunkedRequest(*parser.getCompletedRequest());
+    // 同一连接上的下一个请求照常解析
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    expectGetRequest(*parser.getCompletedRequest());
+    EXPECT_FALSE(parser.hasError());
+}
+
+TEST(HttpParserTest, DecodesChunkedBodyAcrossEverySplitPoint) {
+    for (size_t split = 1; split < kChunkedRequest.size(); ++split) {
+        HttpParser parser;
+        parser.parse(kChunkedRequest.data(), split);
+        EXPECT_FALSE(parser.hasCompletedRequest()) << "split at " << split;
+        parser.parse(kChunkedRequest.data() + split, kChunkedRequest.size() - split);
+
+        ASSERT_TRUE(parser.hasCompletedRequest()) << "split at " << split;
+        expectChunkedRequest(*parser.getCompletedRequest());
+    }
+}
+
+TEST(HttpParserTest, SpillsChunkedBodyPastThreshold) {
+    HttpParser parser;
+    parser.setBodySpill(8, "/tmp");
+    parser.parse(kChunkedRequest.data(), kChunkedRequest.size());
+
+    ASSERT_TRUE(parser.hasCompletedRequest());
+    auto request = parser.getCompletedRequest();
+    EXPECT_TRUE(request->isBodySpilled());
+    EXPECT_EQ(request->getBody(), "hello, world");
+}
+
+TEST(HttpParserTest, RejectsMalformedChunkedRequests) {
+    const std::string bad[] = {
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 5\r\n\r\n0\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcX\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nfffffffffffffffff\r\n",
+    };
+    for (const auto& request : bad) {
+        HttpParser parser;
+        parser.parse(request.data(), request.size());
+        EXPECT_TRUE(parser.hasError()) << request;
+    }
+}
+
+TEST(HttpParserTest, RejectsUnknownMethod) {
+    HttpParser parser;
+    std::string request = "BREW /pot HTTP/1.1\r\n\r\n";
+    parser.parse(request.data(), request.size());
+
+    EXPECT_TRUE(parser.hasError());
+    EXPECT_FALSE(parser.hasCompletedRequest());
+}
+
+TEST(HttpParserTest, RejectsInvalidContentLength) {
+    HttpParser parser;
+    std::string request = "POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n";
+    parser.parse(request.data(), request.size());
+
+    EXPECT_TRUE(parser.hasError());
+}
+
+TEST(HttpParserTest, RejectsConflictingContentLength) {
+    HttpParser parser;
+    std::string request = "POST / HTTP/1.1\r\nContent-Length: 0\r\nContent-Length: 5\r\n\r\nhello";
+    parser.parse(request.data(), request.size());
+    EXPECT_TRUE(parser.hasError());
+    EXPECT_FALSE(parser.hasCompletedRequest());
+
+    // 取值相同的重复头部不影响分帧
+    HttpParser same;
+    request = "POST / HTTP/1.1\r\nContent-Length: 5\r\ncontent-length: 5\r\n\r\nhello";
+    same.parse(request.data(), request.size());
+    ASSERT_TRUE(same.hasCompletedRequest());
+    EXPECT_EQ(same.getCompletedRequest()->getBody(), "hello");
+}
+
+TEST(HttpParserTest, RejectsRepeatedTransferEncoding) {
+    const std::string bad[] = {
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: identity\r\n\r\n0\r\n\r\n",
+        "POST / HTTP/1.1\r\nContent-Length: 3\r\ntransfer-encoding: chunked\r\n\r\n0\r\n\r\n",
+    };
+    for (const auto& request : bad) {
+        HttpParser parser;
+        parser.parse(request.data(), request.size());
+        EXPECT_TRUE(parser.hasError()) << request;
+    }
+}
+
+TEST(HttpParserTest, RejectsOversizedHeader) {
+    HttpParser parser;
+    std::string request = "GET / HTTP/1.1\r\nX-Long: ";
+    parser.parse(request.data(), request.size());
+    std::string chunk(4096, 'a');
+    for (size_t sent = 0; sent <= HttpParser::MAX_HEADER_SIZE && !parser.hasError(); sent += chunk.size()) {
+        parser.parse(chunk.data(), chunk.size());
+    }
+
+    EXPECT_TRUE(parser.hasError());
+}
+
+TEST(HttpParserTest, ParsesViewInPlace) {
+    HttpRequestView view;
+    auto status = HttpParser::parseView(kRequest.data(), kRequest.size(), view);
+
+    ASSERT_EQ(status, HttpParser::ViewStatus::COMPLETE);
+    EXPECT_EQ(view.method, HttpMethod::GET);
+    EXPECT_EQ(view.path, "/index.html");
+    EXPECT_EQ(view.query, "lang=en");
+    EXPECT_EQ(view.header_count, 3u);
+    EXPECT_EQ(view.header_length, kRequest.size());
+    EXPECT_EQ(view.getHeader("user-agent"), "Mozilla/5.0");
+    // 视图指向输入缓冲区本身，没有拷贝
+    EXPECT_GE(view.path.data(), kRequest.data());
+    EXPECT_LT(view.path.data(), kRequest.data() + kRequest.size());
+}
+
+TEST(HttpParserTest, ViewReportsIncompleteAndError) {
+    HttpRequestView view;
+    EXPECT_EQ(HttpParser::parseView(kRequest.data(), kRequest.size() - 1, view),
+              HttpParser::ViewStatus::INCOMPLETE);
+
+    std::string bad = "GET / HTTP/1.1\r\nNoColon\r\n\r\n";
+    EXPECT_EQ(HttpParser::parseView(bad.data(), bad.size(), view), HttpParser::ViewStatus::ERROR);
+}
+
+TEST(HttpParserTest, ViewRejectsControlCharactersAndBareCr) {
+    HttpRequestView view;
+    const std::string bad[] = {
+        std::string("GET /a\x01 HTTP/1.1\r\n\r\n"),
+        std::string("GET / HTTP/1.1\r\nX-A: b\x7f\r\n\r\n"),
+        std::string("GET / HTTP/1.1\r\nX-A: b\rc\r\n\r\n"),
+        std::string("GET / HTTP/1.1\r\nHost : a\r\n\r\n"),
+        std::string("GET / HTTP/1.1\r\nX-A: ") + std::string(100, 'a') + '\0' + "\r\n\r\n",
+    };
+    for (const auto& request : bad) {
+        EXPECT_EQ(HttpParser::parseView(request.data(), request.size(), view),
+                  HttpParser::ViewStatus::ERROR) << request;
+    }
+}
+
+TEST(HttpParserTest, ViewParsesLinesAcrossBlocks) {
+    // 头部值跨越多个 64 字节扫描块，制表符在值中合法
+    std::string cookie(300, 'c');
+    std::string request = "GET / HTTP/1.1\r\nCookie: " + cookie + "\r\nX-Tab:\ta\tb\r\nHost: h\r\n\r\n";
+    HttpRequestView view;
+    ASSERT_EQ(HttpParser::parseView(request.data(), request.size(), view),
+              HttpParser::ViewStatus::COMPLETE);
+    EXPECT_EQ(view.getHeader("Cookie"), cookie);
+    EXPECT_EQ(view.getHeader("X-Tab"), "a\tb");
+    EXPECT_EQ(view.getHeader("Host"), "h");
+    EXPECT_EQ(view.header_length, request.size());
+
+    for (size_t len = 0; len < request.size(); ++len) {
+        EXPECT_EQ(HttpParser::parseView(request.data(), len, view),
+                  HttpParser::ViewStatus::INCOMPLETE) << "length " << len;
+    }
+}
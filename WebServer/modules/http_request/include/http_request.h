@@ -1,7 +1,16 @@
 #pragma once
 #include "http_types.h"
 #include <string>
+#include <string_view>
 #include <memory>
+#include <vector>
+
+// 请求体的逐块消费者：流式路由在请求头到达后创建，请求体到达一块交给它一块，不在内存中累积
+class RequestBodySink {
+public:
+    virtual ~RequestBodySink() = default;
+    virtual void onBodyData(const char* data, size_t len) = 0;
+};
 
 class HttpRequest {
 public:
@@ -18,11 +27,21 @@ public:
 
     // Setters
     void setMethod(HttpMethod method);
-    void setPath(const std::string& path);
-    void setQuery(const std::string& query);
+    void setPath(std::string_view path);
+    void setQuery(std::string_view query);
     void setVersion(HttpVersion version);
-    void setHeader(const std::string& key, const std::string& value);
+    void setHeader(std::string_view key, std::string_view value);
     void setBody(const std::string& body);
+    // 请求体原地追加，解析器按 Content-Length 预留容量，整个请求体只拷贝一次
+    void reserveBody(size_t size);
+    void appendBody(const char* data, size_t len);
+    // 分片模式：请求体保存为若干块，每块容量不超过 slice_size，避免大上传的单次巨型分配
+    void appendBodySlice(const char* data, size_t len, size_t slice_size, size_t remaining);
+    // 流式模式：此后 appendBody 的数据直接交给 sink
+    void setBodySink(std::unique_ptr<RequestBodySink> sink);
+    // 落盘模式：已累积和此后 appendBody 的数据写入 directory 下的匿名临时文件 (O_TMPFILE)，
+    // 文件随请求销毁自动删除；创建或写入失败时抛出 std::system_error
+    void spillBody(const std::string& directory);
 
     // Getters
     HttpMethod getMethod() const;
@@ -30,7 +49,15 @@ public:
     const std::string& getQuery() const;
     HttpVersion getVersion() const;
     const Headers& getHeaders() const;
+    // 分片和落盘模式下首次调用时才把请求体拼接/读回内存；流式模式下为空
     const std::string& getBody() const;
+    size_t getBodyLength() const;
+    // 分片模式下的各块，非分片模式为空
+    const std::vector<std::string>& getBodySlices() const;
+    RequestBodySink* getBodySink() const;
+    bool isBodySpilled() const;
+    // 落盘文件的描述符，未落盘时为 -1
+    int getBodyFd() const;
 
     // Utility methods
     std::string getParameter(const std::string& key) const;
@@ -42,12 +69,29 @@ public:
     void parseQueryString();
 
 private:
+    // 持有落盘文件描述符，随请求移动，析构时关闭
+    class BodyFile {
+    public:
+        BodyFile() = default;
+        ~BodyFile();
+        BodyFile(BodyFile&& other) noexcept;
+        BodyFile& operator=(BodyFile&& other) noexcept;
+        void reset(int fd);
+        int get() const { return fd_; }
+    private:
+        int fd_ = -1;
+    };
+
     HttpMethod method_;
     std::string path_;
     std::string query_;
     HttpVersion version_;
     Headers headers_;
-    std::string body_;
+    mutable std::string body_;
+    std::vector<std::string> body_slices_;
+    size_t body_length_;
+    std::unique_ptr<RequestBodySink> body_sink_;
+    BodyFile body_file_;
     Parameters parameters_;
 };
 
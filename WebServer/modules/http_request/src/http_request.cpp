@@ -1,19 +1,48 @@
 #include "http_request.h"
-#include <sstream>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <cerrno>
+#include <sstream>
+#include <system_error>
+
+HttpRequest::BodyFile::~BodyFile() {
+    reset(-1);
+}
+
+HttpRequest::BodyFile::BodyFile(BodyFile&& other) noexcept : fd_(other.fd_) {
+    other.fd_ = -1;
+}
+
+HttpRequest::BodyFile& HttpRequest::BodyFile::operator=(BodyFile&& other) noexcept {
+    if (this != &other) {
+        reset(other.fd_);
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+void HttpRequest::BodyFile::reset(int fd) {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+    fd_ = fd;
+}
 
 HttpRequest::HttpRequest()
-    : method_(HttpMethod::GET), version_(HttpVersion::HTTP_1_1) {}
+    : method_(HttpMethod::GET), version_(HttpVersion::HTTP_1_1), body_length_(0) {}
 
 void HttpRequest::setMethod(HttpMethod method) {
     method_ = method;
 }
 
-void HttpRequest::setPath(const std::string& path) {
+void HttpRequest::setPath(std::string_view path) {
     path_ = path;
 }
 
-void HttpRequest::setQuery(const std::string& query) {
+void HttpRequest::setQuery(std::string_view query) {
     query_ = query;
     parseQueryString();
 }
@@ -22,12 +51,55 @@ void HttpRequest::setVersion(HttpVersion version) {
     version_ = version;
 }
 
-void HttpRequest::setHeader(const std::string& key, const std::string& value) {
-    headers_[key] = value;
+void HttpRequest::setHeader(std::string_view key, std::string_view value) {
+    headers_[std::string(key)] = value;
 }
 
 void HttpRequest::setBody(const std::string& body) {
     body_ = body;
+    body_slices_.clear();
+    body_length_ = body.length();
+}
+
+void HttpRequest::reserveBody(size_t size) {
+    body_.reserve(size);
+}
+
+void HttpRequest::appendBody(const char* data, size_t len) {
+    if (body_sink_) {
+        body_sink_->onBodyData(data, len);
+    } else if (body_file_.get() >= 0) {
+        for (size_t written = 0; written < len;) {
+            ssize_t n = write(body_file_.get(), data + written, len - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "write request body");
+            }
+            written += n;
+        }
+    } else {
+        body_.append(data, len);
+    }
+    body_length_ += len;
+}
+
+void HttpRequest::appendBodySlice(const char* data, size_t len, size_t slice_size, size_t remaining) {
+    // remaining 为本次追加前还未收到的字节数，用来给新块预留恰好够用的容量
+    while (len > 0) {
+        if (body_slices_.empty() || body_slices_.back().length() == slice_size) {
+            body_slices_.emplace_back();
+            body_slices_.back().reserve(std::min(slice_size, remaining));
+        }
+        std::string& slice = body_slices_.back();
+        size_t n = std::min(len, slice_size - slice.length());
+        slice.append(data, n);
+        data += n;
+        len -= n;
+        remaining -= n;
+        body_length_ += n;
+    }
 }
 
 HttpMethod HttpRequest::getMethod() const {
@@ -50,10 +122,81 @@ const Headers& HttpRequest::getHeaders() const {
     return headers_;
 }
 
+void HttpRequest::setBodySink(std::unique_ptr<RequestBodySink> sink) {
+    body_sink_ = std::move(sink);
+}
+
+void HttpRequest::spillBody(const std::string& directory) {
+    int fd = open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0 && (errno == EOPNOTSUPP || errno == EISDIR)) {
+        // 文件系统不支持 O_TMPFILE 时退回到创建后立即删除的普通临时文件
+        std::string path = directory + "/body-XXXXXX";
+        fd = mkostemp(path.data(), O_CLOEXEC);
+        if (fd >= 0) {
+            unlink(path.c_str());
+        }
+    }
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "create body spill file in " + directory);
+    }
+    body_file_.reset(fd);
+
+    // 已经在内存中的部分 (chunked 请求体累积到阈值后才落盘) 先写入文件
+    std::string buffered = std::move(body_);
+    std::vector<std::string> slices = std::move(body_slices_);
+    body_.clear();
+    body_slices_.clear();
+    body_length_ = 0;
+    appendBody(buffered.data(), buffered.length());
+    for (const auto& slice : slices) {
+        appendBody(slice.data(), slice.length());
+    }
+}
+
 const std::string& HttpRequest::getBody() const {
+    if (body_file_.get() >= 0 && body_.length() != body_length_) {
+        body_.resize(body_length_);
+        size_t done = 0;
+        while (done < body_length_) {
+            ssize_t n = pread(body_file_.get(), body_.data() + done, body_length_ - done, done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::system_error(n < 0 ? errno : EIO, std::generic_category(), "read spilled request body");
+            }
+            done += n;
+        }
+    } else if (!body_slices_.empty() && body_.length() != body_length_) {
+        body_.clear();
+        body_.reserve(body_length_);
+        for (const auto& slice : body_slices_) {
+            body_.append(slice);
+        }
+    }
     return body_;
 }
 
+size_t HttpRequest::getBodyLength() const {
+    return body_length_;
+}
+
+const std::vector<std::string>& HttpRequest::getBodySlices() const {
+    return body_slices_;
+}
+
+RequestBodySink* HttpRequest::getBodySink() const {
+    return body_sink_.get();
+}
+
+bool HttpRequest::isBodySpilled() const {
+    return body_file_.get() >= 0;
+}
+
+int HttpRequest::getBodyFd() const {
+    return body_file_.get();
+}
+
 std::string HttpRequest::getParameter(const std::string& key) const {
     auto it = parameters_.find(key);
     return (it != parameters_.end()) ? it->second : "";
@@ -1,7 +1,45 @@
 #pragma once
 
 #include "http_types.h"
+#include <sys/types.h>
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+
+// 流式响应体的生产者：每次调用向 chunk 追加一段数据，返回 false 表示响应体已经结束
+// 服务器在连接可写、前面的输出都发出后才调用它，每次只生成一小段，响应体不需要整体驻留内存
+using BodyProducer = std::function<bool(std::string& chunk)>;
+
+// 打开的只读文件，最后一个引用释放时关闭
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd);
+    ~FileDescriptor();
+
+    // 禁用拷贝
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    int get() const;
+
+private:
+    int fd_;
+};
+
+// 文件响应体：发送时用 sendfile(2) 直接从页缓存写入 socket，不经过用户态缓冲区
+struct FileBody {
+    std::shared_ptr<const FileDescriptor> file;
+    off_t offset = 0;
+    std::size_t length = 0;
+};
+
+// 文件响应体的一段：file.file 为空时是内存数据 data（如 multipart/byteranges 的分段头）
+struct BodySegment {
+    std::string data;
+    FileBody file;
+};
 
 class HttpResponse {
 public:
@@ -20,25 +58,46 @@ public:
     HttpResponse& setStatusCode(HttpStatusCode code);
     HttpResponse& setVersion(HttpVersion version);
     HttpResponse& setHeader(const std::string& key, const std::string& value);
-    HttpResponse& setBody(const std::string& body);
+    HttpResponse& setBody(std::string body);
     HttpResponse& appendBody(const std::string& str);
+    // 流式响应：HTTP/1.1 以 Transfer-Encoding: chunked 发送，HTTP/1.0 发送原始数据后关闭连接
+    HttpResponse& setBodyProducer(BodyProducer producer);
+    // 文件响应体：发送 file 中 [offset, offset + length) 的内容
+    HttpResponse& setBodyFile(std::shared_ptr<const FileDescriptor> file, off_t offset, std::size_t length);
+    // 在文件响应体后继续追加一段文件内容或一段内存数据，按追加顺序发送
+    HttpResponse& appendBodyFile(std::shared_ptr<const FileDescriptor> file, off_t offset, std::size_t length);
+    HttpResponse& appendBodySegment(std::string data);
+    // 预先序列化好的完整响应（状态行 + 头部 + 响应体），多个连接共享同一份内存，发送时不再序列化和拷贝
+    HttpResponse& setSerialized(std::shared_ptr<const std::string> bytes);
 
     // Getters
     HttpStatusCode getStatusCode() const;
     HttpVersion getVersion() const;
     const Headers& getHeaders() const;
     const std::string& getBody() const;
+    bool isStreaming() const;
+    BodyProducer takeBodyProducer();
+    bool hasBodyFile() const;
+    std::vector<BodySegment> takeBodySegments();
+    bool isSerialized() const;
+    std::shared_ptr<const std::string> takeSerialized();
 
     // Utility methods
     std::string getHeader(const std::string& key) const;
     bool hasHeader(const std::string& key) const;
 
-    // 序列化响应为字符串
+    // 序列化响应为字符串；Content-Length 在此时按响应体长度生成，流式响应、文件响应和无响应体的状态码只序列化状态行和头部
+    // 已预先序列化的响应直接返回那份内容
     std::string toString() const;
+    // 只序列化状态行和头部（含 Content-Length），响应体由调用方另行发送，不拷贝
+    std::string serializeHeaders() const;
+    // 取走 toString() 会发送的内存响应体；须在 serializeHeaders() 之后调用
+    std::string takeBody();
 
     // 快捷方法创建常见响应类型
     static HttpResponse newHttpResponse();
     static HttpResponse makeOkResponse();
+    static HttpResponse makeBadRequestResponse();
     static HttpResponse makeNotFoundResponse();
     static HttpResponse makeInternalServerErrorResponse();
 
@@ -50,6 +109,9 @@ private:
     HttpVersion version_;
     Headers headers_;
     std::string body_;
+    BodyProducer producer_;
+    std::vector<BodySegment> segments_;
+    std::shared_ptr<const std::string> serialized_;
 
-    void updateContentLength();
+    bool hasMessageBody() const;
 };
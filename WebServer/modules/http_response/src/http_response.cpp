@@ -1,5 +1,19 @@
 #include "http_response.h"
-#include <sstream>
+#include <unistd.h>
+#include <string>
+#include <utility>
+
+FileDescriptor::FileDescriptor(int fd) : fd_(fd) {}
+
+FileDescriptor::~FileDescriptor() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+int FileDescriptor::get() const {
+    return fd_;
+}
 
 HttpResponse::HttpResponse()
     : statusCode_(HttpStatusCode::OK), 
@@ -20,15 +34,39 @@ HttpResponse& HttpResponse::setHeader(const std::string& key, const std::string&
     return *this;
 }
 
-HttpResponse& HttpResponse::setBody(const std::string& body) {
-    body_ = body;
-    updateContentLength();
+HttpResponse& HttpResponse::setBody(std::string body) {
+    body_ = std::move(body);
     return *this;
 }
 
 HttpResponse& HttpResponse::appendBody(const std::string& str) {
     body_ += str;
-    updateContentLength();
+    return *this;
+}
+
+HttpResponse& HttpResponse::setBodyProducer(BodyProducer producer) {
+    producer_ = std::move(producer);
+    return *this;
+}
+
+HttpResponse& HttpResponse::setBodyFile(std::shared_ptr<const FileDescriptor> file, off_t offset, std::size_t length) {
+    segments_.clear();
+    body_.clear();
+    return appendBodyFile(std::move(file), offset, length);
+}
+
+HttpResponse& HttpResponse::appendBodyFile(std::shared_ptr<const FileDescriptor> file, off_t offset, std::size_t length) {
+    segments_.push_back({std::string(), {std::move(file), offset, length}});
+    return *this;
+}
+
+HttpResponse& HttpResponse::appendBodySegment(std::string data) {
+    segments_.push_back({std::move(data), {}});
+    return *this;
+}
+
+HttpResponse& HttpResponse::setSerialized(std::shared_ptr<const std::string> bytes) {
+    serialized_ = std::move(bytes);
     return *this;
 }
 
@@ -48,6 +86,37 @@ const std::string& HttpResponse::getBody() const {
     return body_;
 }
 
+bool HttpResponse::isStreaming() const {
+    return static_cast<bool>(producer_);
+}
+
+BodyProducer HttpResponse::takeBodyProducer() {
+    return std::move(producer_);
+}
+
+bool HttpResponse::hasBodyFile() const {
+    return !segments_.empty();
+}
+
+std::vector<BodySegment> HttpResponse::takeBodySegments() {
+    return std::exchange(segments_, {});
+}
+
+bool HttpResponse::isSerialized() const {
+    return static_cast<bool>(serialized_);
+}
+
+std::shared_ptr<const std::string> HttpResponse::takeSerialized() {
+    return std::move(serialized_);
+}
+
+std::string HttpResponse::takeBody() {
+    if (!hasMessageBody() || !segments_.empty()) {
+        return std::string();
+    }
+    return std::exchange(body_, {});
+}
+
 std::string HttpResponse::getHeader(const std::string& key) const {
     auto it = headers_.find(key);
     return (it != headers_.end()) ? it->second : "";
@@ -57,17 +126,44 @@ bool HttpResponse::hasHeader(const std::string& key) const {
     return headers_.find(key) != headers_.end();
 }
 
-std::string HttpResponse::toString() const {
-    std::ostringstream oss;
-    oss << (version_ == HttpVersion::HTTP_1_1 ? "HTTP/1.1 " : "HTTP/1.0 ")
-        << static_cast<int>(statusCode_) << " " << getStatusMessage(statusCode_) << "\r\n";
+std::string HttpResponse::serializeHeaders() const {
+    std::string out;
+    out.reserve(256);
+    out.append(version_ == HttpVersion::HTTP_1_1 ? "HTTP/1.1 " : "HTTP/1.0 ")
+       .append(std::to_string(static_cast<int>(statusCode_))).append(" ")
+       .append(getStatusMessage(statusCode_)).append("\r\n");
 
     for (const auto& [key, value] : headers_) {
-        oss << key << ": " << value << "\r\n";
+        out.append(key).append(": ").append(value).append("\r\n");
     }
-    oss << "\r\n";
-    oss << body_;
-    return oss.str();
+    if (hasMessageBody() && !hasHeader("Content-Length")) {
+        std::size_t length = body_.length();
+        for (const auto& segment : segments_) {
+            length += segment.file.file ? segment.file.length : segment.data.size();
+        }
+        out.append("Content-Length: ").append(std::to_string(length)).append("\r\n");
+    }
+    out.append("\r\n");
+    return out;
+}
+
+std::string HttpResponse::toString() const {
+    if (serialized_) {
+        return *serialized_;
+    }
+    std::string out = serializeHeaders();
+    if (hasMessageBody() && segments_.empty()) {
+        out.append(body_);
+    }
+    return out;
+}
+
+bool HttpResponse::hasMessageBody() const {
+    // 1xx、204、304 没有响应体，也不能声明 Content-Length: 0（304 的长度指的是完整表示）
+    // 流式响应体的长度由分块编码或关闭连接表示
+    int code = static_cast<int>(statusCode_);
+    return !producer_ && code >= 200 && statusCode_ != HttpStatusCode::NO_CONTENT &&
+           statusCode_ != HttpStatusCode::NOT_MODIFIED;
 }
 
 HttpResponse HttpResponse::newHttpResponse() {
@@ -82,6 +178,15 @@ HttpResponse HttpResponse::makeOkResponse() {
     return resp;
 }
 
+HttpResponse HttpResponse::makeBadRequestResponse() {
+    HttpResponse resp;
+    resp.setStatusCode(HttpStatusCode::BAD_REQUEST)
+        .setHeader("Content-Type", "text/plain")
+        .setHeader("Connection", "close")
+        .setBody("400 Bad Request");
+    return resp;
+}
+
 HttpResponse HttpResponse::makeNotFoundResponse() {
     HttpResponse resp;
     resp.setStatusCode(HttpStatusCode::NOT_FOUND)
@@ -104,13 +209,16 @@ std::string HttpResponse::getStatusMessage(HttpStatusCode code) {
         case HttpStatusCode::CREATED: return "Created";
         case HttpStatusCode::ACCEPTED: return "Accepted";
         case HttpStatusCode::NO_CONTENT: return "No Content";
+        case HttpStatusCode::PARTIAL_CONTENT: return "Partial Content";
         case HttpStatusCode::MOVED_PERMANENTLY: return "Moved Permanently";
         case HttpStatusCode::FOUND: return "Found";
+        case HttpStatusCode::NOT_MODIFIED: return "Not Modified";
         case HttpStatusCode::BAD_REQUEST: return "Bad Request";
         case HttpStatusCode::UNAUTHORIZED: return "Unauthorized";
         case HttpStatusCode::FORBIDDEN: return "Forbidden";
         case HttpStatusCode::NOT_FOUND: return "Not Found";
         case HttpStatusCode::METHOD_NOT_ALLOWED: return "Method Not Allowed";
+        case HttpStatusCode::RANGE_NOT_SATISFIABLE: return "Range Not Satisfiable";
         case HttpStatusCode::INTERNAL_SERVER_ERROR: return "Internal Server Error";
         case HttpStatusCode::NOT_IMPLEMENTED: return "Not Implemented";
         case HttpStatusCode::BAD_GATEWAY: return "Bad Gateway";
@@ -118,7 +226,3 @@ std::string HttpResponse::getStatusMessage(HttpStatusCode code) {
         default: return "Unknown Status";
     }
 }
-
-void HttpResponse::updateContentLength() {
-    setHeader("Content-Length", std::to_string(body_.length()));
-}
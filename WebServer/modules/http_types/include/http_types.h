@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <optional>
 #include <variant>
@@ -31,21 +33,41 @@ enum class HttpStatusCode {
     CREATED = 201,
     ACCEPTED = 202,
     NO_CONTENT = 204,
+    PARTIAL_CONTENT = 206,
     MOVED_PERMANENTLY = 301,
     FOUND = 302,
+    NOT_MODIFIED = 304,
     BAD_REQUEST = 400,
     UNAUTHORIZED = 401,
     FORBIDDEN = 403,
     NOT_FOUND = 404,
     METHOD_NOT_ALLOWED = 405,
+    RANGE_NOT_SATISFIABLE = 416,
     INTERNAL_SERVER_ERROR = 500,
     NOT_IMPLEMENTED = 501,
     BAD_GATEWAY = 502,
     SERVICE_UNAVAILABLE = 503
 };
 
+// ASCII 大小写不敏感比较，用于头部名和大小写不敏感的字段值 (如 chunked、bytes)
+bool equals_ignore_case(std::string_view a, std::string_view b);
+
+// 去掉首尾的空格和制表符 (HTTP 的 OWS)，用于头部值和逗号分隔列表中的各项
+std::string_view trim_ows(std::string_view text);
+
+// 头部名大小写不敏感 (RFC 9110)：按小写计算哈希、忽略大小写比较
+struct HeaderNameHash {
+    std::size_t operator()(std::string_view name) const;
+};
+
+struct HeaderNameEqual {
+    bool operator()(std::string_view a, std::string_view b) const {
+        return equals_ignore_case(a, b);
+    }
+};
+
 // HTTP 头部类型
-using Headers = std::unordered_map<std::string, std::string>;
+using Headers = std::unordered_map<std::string, std::string, HeaderNameHash, HeaderNameEqual>;
 
 // HTTP 参数类型
 using Parameters = std::unordered_map<std::string, std::string>;
@@ -60,13 +82,13 @@ struct HttpError {
 std::optional<std::string> method_to_string(HttpMethod method);
 
 // 将字符串转换为 HttpMethod 枚举
-std::variant<HttpMethod, HttpError> string_to_method(const std::string& method_str);
+std::variant<HttpMethod, HttpError> string_to_method(std::string_view method_str);
 
 // 将 HttpVersion 枚举转换为字符串
 std::optional<std::string> version_to_string(HttpVersion version);
 
 // 将字符串转换为 HttpVersion 枚举
-std::variant<HttpVersion, HttpError> string_to_version(const std::string& version_str);
+std::variant<HttpVersion, HttpError> string_to_version(std::string_view version_str);
 
 // 获取状态码对应的描述
 std::optional<std::string> status_code_to_string(HttpStatusCode status_code);
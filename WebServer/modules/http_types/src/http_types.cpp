@@ -1,5 +1,6 @@
 #include "http_types.h"
 #include <unordered_map>
+#include <utility>
 
 std::optional<std::string> method_to_string(HttpMethod method) {
     static const std::unordered_map<HttpMethod, std::string> method_map = {
@@ -21,8 +22,9 @@ std::optional<std::string> method_to_string(HttpMethod method) {
     return std::nullopt;
 }
 
-std::variant<HttpMethod, HttpError> string_to_method(const std::string& method_str) {
-    static const std::unordered_map<std::string, HttpMethod> method_map = {
+std::variant<HttpMethod, HttpError> string_to_method(std::string_view method_str) {
+    // 方法数量很少，线性比较比哈希查找更快，也不需要构造 std::string
+    static constexpr std::pair<std::string_view, HttpMethod> method_map[] = {
         {"GET", HttpMethod::GET},
         {"POST", HttpMethod::POST},
         {"PUT", HttpMethod::PUT},
@@ -34,9 +36,10 @@ std::variant<HttpMethod, HttpError> string_to_method(const std::string& method_s
         {"CONNECT", HttpMethod::CONNECT}
     };
 
-    auto it = method_map.find(method_str);
-    if (it != method_map.end()) {
-        return it->second;
+    for (const auto& [name, method] : method_map) {
+        if (name == method_str) {
+            return method;
+        }
     }
     return HttpError{HttpStatusCode::BAD_REQUEST, "Invalid HTTP method string"};
 }
@@ -50,7 +53,7 @@ std::optional<std::string> version_to_string(HttpVersion version) {
     }
 }
 
-std::variant<HttpVersion, HttpError> string_to_version(const std::string& version_str) {
+std::variant<HttpVersion, HttpError> string_to_version(std::string_view version_str) {
     if (version_str == "HTTP/1.0") return HttpVersion::HTTP_1_0;
     if (version_str == "HTTP/1.1") return HttpVersion::HTTP_1_1;
     if (version_str == "HTTP/2.0") return HttpVersion::HTTP_2_0;
@@ -63,13 +66,16 @@ std::optional<std::string> status_code_to_string(HttpStatusCode status_code) {
         {HttpStatusCode::CREATED, "201 Created"},
         {HttpStatusCode::ACCEPTED, "202 Accepted"},
         {HttpStatusCode::NO_CONTENT, "204 No Content"},
+        {HttpStatusCode::PARTIAL_CONTENT, "206 Partial Content"},
         {HttpStatusCode::MOVED_PERMANENTLY, "301 Moved Permanently"},
         {HttpStatusCode::FOUND, "302 Found"},
+        {HttpStatusCode::NOT_MODIFIED, "304 Not Modified"},
         {HttpStatusCode::BAD_REQUEST, "400 Bad Request"},
         {HttpStatusCode::UNAUTHORIZED, "401 Unauthorized"},
         {HttpStatusCode::FORBIDDEN, "403 Forbidden"},
         {HttpStatusCode::NOT_FOUND, "404 Not Found"},
         {HttpStatusCode::METHOD_NOT_ALLOWED, "405 Method Not Allowed"},
+        {HttpStatusCode::RANGE_NOT_SATISFIABLE, "416 Range Not Satisfiable"},
         {HttpStatusCode::INTERNAL_SERVER_ERROR, "500 Internal Server Error"},
         {HttpStatusCode::NOT_IMPLEMENTED, "501 Not Implemented"},
         {HttpStatusCode::BAD_GATEWAY, "502 Bad Gateway"},
@@ -82,3 +88,39 @@ std::optional<std::string> status_code_to_string(HttpStatusCode status_code) {
     }
     return std::nullopt;
 }
+
+static char to_lower_ascii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+bool equals_ignore_case(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (to_lower_ascii(a[i]) != to_lower_ascii(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim_ows(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+std::size_t HeaderNameHash::operator()(std::string_view name) const {
+    // FNV-1a
+    std::size_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(to_lower_ascii(c));
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
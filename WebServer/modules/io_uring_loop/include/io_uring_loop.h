@@ -0,0 +1,111 @@
+#pragma once
+
+#include "timing_wheel.h"
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 基于原始系统调用的 io_uring 完成事件循环，不依赖 liburing
+// 除 quit 外，其余方法只能在运行 loop 的线程中调用
+class IoUringLoop {
+public:
+    using CompletionCallback = std::function<void(const io_uring_cqe &)>;
+
+    explicit IoUringLoop(unsigned entries);
+    ~IoUringLoop();
+
+    // 禁用拷贝
+    IoUringLoop(const IoUringLoop&) = delete;
+    IoUringLoop& operator=(const IoUringLoop&) = delete;
+
+    void loop();
+    void quit();
+
+    void setCompletionCallback(CompletionCallback callback);
+
+    // 提供缓冲区环 (provided buffer ring)，multishot recv 由内核从中挑选缓冲区
+    // 内核不支持时回退到 IORING_OP_PROVIDE_BUFFERS
+    void setupBufferRing(uint16_t group_id, unsigned count, unsigned size);
+    const char *getBuffer(uint16_t buffer_id) const;
+    void recycleBuffer(uint16_t buffer_id);
+
+    // 准备 SQE，下一轮循环由一次 io_uring_enter 批量提交
+    void prepareMultishotAccept(int fd, uint64_t user_data);
+    void prepareMultishotRecv(int fd, uint64_t user_data);
+    // msg 及其引用的 iovec 和数据在完成前必须保持有效
+    void prepareSendMsg(int fd, const msghdr *msg, uint64_t user_data, int flags = 0);
+    // 单次 POLLOUT 等待，socket 可写时完成
+    void preparePollOut(int fd, uint64_t user_data);
+    // 取消 user_data 为 target 的在途请求（如 multishot recv），被取消的请求以 -ECANCELED 完成
+    // 取消请求自身的完成事件在内部消化，不交给上层
+    void prepareCancel(uint64_t target);
+
+    // 定时器：时间轮非空时挂一个到下一次转动为止的 IORING_OP_TIMEOUT，回调在循环线程中执行
+    TimingWheel &timers();
+
+private:
+    // 内部使用的 user_data，上层不会用到这些值
+    static constexpr uint64_t WAKEUP_USER_DATA = UINT64_MAX;
+    static constexpr uint64_t INTERNAL_USER_DATA = UINT64_MAX - 1;
+    static constexpr uint64_t CANCEL_USER_DATA = UINT64_MAX - 2;
+    static constexpr uint64_t TIMER_USER_DATA = UINT64_MAX - 3;
+
+    int ring_fd_;
+    int wakeup_fd_;
+    std::atomic<bool> quit_;
+    CompletionCallback completion_callback_;
+    uint64_t wakeup_value_;
+    unsigned sq_entries_;
+    TimingWheel timers_;
+    __kernel_timespec timer_spec_;
+    bool timer_armed_;
+
+    void *sq_ring_ptr_;
+    std::size_t sq_ring_size_;
+    void *cq_ring_ptr_;
+    std::size_t cq_ring_size_;
+    io_uring_sqe *sqes_;
+    std::size_t sqes_size_;
+
+    unsigned *sq_head_;
+    unsigned *sq_tail_;
+    unsigned *sq_mask_;
+    unsigned *sq_array_;
+    unsigned sq_local_tail_;
+    unsigned to_submit_;
+
+    unsigned *cq_head_;
+    unsigned *cq_tail_;
+    unsigned *cq_mask_;
+    io_uring_cqe *cqes_;
+
+    io_uring_buf_ring *buf_ring_;
+    std::size_t buf_ring_size_;
+    std::vector<char> buffers_;
+    unsigned buf_count_;
+    unsigned buf_size_;
+    uint16_t buf_group_;
+    uint16_t buf_tail_;
+    bool use_buf_ring_;
+
+    io_uring_sqe *getSqe();
+    void prepareWakeupRead();
+    void prepareTimer();
+    void prepareProvideBuffers(uint16_t first_id, unsigned count);
+    bool probeBufferRing();
+    io_uring_cqe waitInternalCompletion();
+    // 一次 io_uring_enter 提交所有待提交的 SQE，并至少等待一个完成事件；失败时返回 -errno
+    int submitAndWait();
+    // 返回处理的完成事件数
+    unsigned processCompletions();
+    // EINTR 时重试，失败时返回 -errno
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+    void unmapRings();
+};
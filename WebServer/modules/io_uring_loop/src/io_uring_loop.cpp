@@ -0,0 +1,417 @@
+#include "io_uring_loop.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+IoUringLoop::IoUringLoop(unsigned entries)
+    : ring_fd_(-1),
+      wakeup_fd_(-1),
+      quit_(false),
+      wakeup_value_(0),
+      sq_entries_(0),
+      timer_spec_{},
+      timer_armed_(false),
+      sq_ring_ptr_(MAP_FAILED),
+      sq_ring_size_(0),
+      cq_ring_ptr_(MAP_FAILED),
+      cq_ring_size_(0),
+      sqes_(static_cast<io_uring_sqe *>(MAP_FAILED)),
+      sqes_size_(0),
+      sq_local_tail_(0),
+      to_submit_(0),
+      buf_ring_(static_cast<io_uring_buf_ring *>(MAP_FAILED)),
+      buf_ring_size_(0),
+      buf_count_(0),
+      buf_size_(0),
+      buf_group_(0),
+      buf_tail_(0),
+      use_buf_ring_(false) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0) {
+        LOG_ERROR("io_uring_setup failed: %s", strerror(errno));
+        throw std::runtime_error("io_uring_setup failed");
+    }
+    sq_entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        cq_ring_size_ = sq_ring_size_;
+    }
+
+    sq_ring_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ptr_ != MAP_FAILED) {
+        cq_ring_ptr_ = (params.features & IORING_FEAT_SINGLE_MMAP)
+            ? sq_ring_ptr_
+            : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    if (cq_ring_ptr_ != MAP_FAILED) {
+        sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    }
+    if (sqes_ == MAP_FAILED) {
+        LOG_ERROR("io_uring mmap failed: %s", strerror(errno));
+        unmapRings();
+        close(ring_fd_);
+        throw std::runtime_error("io_uring mmap failed");
+    }
+
+    auto *sq = static_cast<char *>(sq_ring_ptr_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    sq_local_tail_ = *sq_tail_;
+
+    auto *cq = static_cast<char *>(cq_ring_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        LOG_ERROR("eventfd failed: %s", strerror(errno));
+        unmapRings();
+        close(ring_fd_);
+        throw std::runtime_error("eventfd failed");
+    }
+}
+
+IoUringLoop::~IoUringLoop() {
+    if (buf_ring_ != MAP_FAILED) {
+        io_uring_buf_reg reg;
+        std::memset(&reg, 0, sizeof(reg));
+        reg.bgid = buf_group_;
+        syscall(__NR_io_uring_register, ring_fd_, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        munmap(buf_ring_, buf_ring_size_);
+    }
+    unmapRings();
+    close(ring_fd_);
+    close(wakeup_fd_);
+}
+
+void IoUringLoop::loop() {
+    prepareWakeupRead();
+    while (!quit_) {
+        if (!timer_armed_ && !timers_.empty()) {
+            prepareTimer();
+        }
+        int ret = submitAndWait();
+        if (ret == -EAGAIN || ret == -EBUSY) {
+            // 完成队列积压或内核资源暂时不足：先收割已有的完成事件腾出空间再重试，没有可收割的就稍等
+            if (processCompletions() == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            continue;
+        }
+        if (ret < 0) {
+            LOG_FATAL("io_uring_enter failed, stopping loop: %s", strerror(-ret));
+            throw std::runtime_error("io_uring_enter failed: " + std::string(strerror(-ret)));
+        }
+        // 先转动时间轮，完成回调中新挂的定时器从当前时间算起
+        timers_.advance(TimingWheel::Clock::now());
+        processCompletions();
+    }
+}
+
+void IoUringLoop::quit() {
+    quit_ = true;
+    uint64_t one = 1;
+    if (write(wakeup_fd_, &one, sizeof(one)) != sizeof(one)) {
+        LOG_ERROR("IoUringLoop wakeup failed: %s", strerror(errno));
+    }
+}
+
+TimingWheel &IoUringLoop::timers() {
+    return timers_;
+}
+
+void IoUringLoop::setCompletionCallback(CompletionCallback callback) {
+    completion_callback_ = std::move(callback);
+}
+
+void IoUringLoop::unmapRings() {
+    if (sqes_ != MAP_FAILED) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ptr_ != MAP_FAILED && cq_ring_ptr_ != sq_ring_ptr_) {
+        munmap(cq_ring_ptr_, cq_ring_size_);
+    }
+    if (sq_ring_ptr_ != MAP_FAILED) {
+        munmap(sq_ring_ptr_, sq_ring_size_);
+    }
+}
+
+void IoUringLoop::setupBufferRing(uint16_t group_id, unsigned count, unsigned size) {
+    // count 必须是 2 的幂
+    buf_ring_size_ = count * sizeof(io_uring_buf);
+    void *ring = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ring == MAP_FAILED) {
+        LOG_ERROR("Buffer ring mmap failed: %s", strerror(errno));
+        throw std::runtime_error("Buffer ring mmap failed");
+    }
+    // 注册前先写入，确保内核固定的是已分配的物理页
+    std::memset(ring, 0, buf_ring_size_);
+
+    io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = count;
+    reg.bgid = group_id;
+    if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        LOG_ERROR("IORING_REGISTER_PBUF_RING failed: %s", strerror(errno));
+        munmap(ring, buf_ring_size_);
+        throw std::runtime_error("IORING_REGISTER_PBUF_RING failed");
+    }
+
+    buf_ring_ = static_cast<io_uring_buf_ring *>(ring);
+    buf_count_ = count;
+    buf_size_ = size;
+    buf_group_ = group_id;
+    buf_tail_ = 0;
+    use_buf_ring_ = true;
+    buffers_.resize(static_cast<std::size_t>(count) * size);
+    for (unsigned i = 0; i < count; i++) {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+
+    if (!probeBufferRing()) {
+        LOG_WARN("Provided buffer ring not usable, falling back to IORING_OP_PROVIDE_BUFFERS");
+        syscall(__NR_io_uring_register, ring_fd_, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        munmap(buf_ring_, buf_ring_size_);
+        buf_ring_ = static_cast<io_uring_buf_ring *>(MAP_FAILED);
+        use_buf_ring_ = false;
+        prepareProvideBuffers(0, count);
+        io_uring_cqe cqe = waitInternalCompletion();
+        if (cqe.res < 0) {
+            LOG_ERROR("IORING_OP_PROVIDE_BUFFERS failed: %s", strerror(-cqe.res));
+            throw std::runtime_error("IORING_OP_PROVIDE_BUFFERS failed");
+        }
+    }
+}
+
+bool IoUringLoop::probeBufferRing() {
+    // 有的内核注册成功却看不到环上的缓冲区，用 socketpair 上的一次 recv 验证
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) < 0) {
+        return false;
+    }
+    char byte = 0;
+    bool usable = false;
+    if (write(pair[1], &byte, 1) == 1) {
+        io_uring_sqe *sqe = getSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = pair[0];
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = buf_group_;
+        sqe->user_data = INTERNAL_USER_DATA;
+        io_uring_cqe cqe = waitInternalCompletion();
+        usable = cqe.res == 1;
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            recycleBuffer(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+        }
+    }
+    close(pair[0]);
+    close(pair[1]);
+    return usable;
+}
+
+io_uring_cqe IoUringLoop::waitInternalCompletion() {
+    // 仅在 loop 启动前使用，此时环上只有这一个请求
+    io_uring_cqe cqe;
+    std::memset(&cqe, 0, sizeof(cqe));
+    cqe.res = -EIO;
+    int ret = submitAndWait();
+    if (ret < 0) {
+        LOG_ERROR("io_uring_enter failed: %s", strerror(-ret));
+        return cqe;
+    }
+    unsigned head = *cq_head_;
+    cqe = cqes_[head & *cq_mask_];
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return cqe;
+}
+
+const char *IoUringLoop::getBuffer(uint16_t buffer_id) const {
+    return buffers_.data() + static_cast<std::size_t>(buffer_id) * buf_size_;
+}
+
+void IoUringLoop::recycleBuffer(uint16_t buffer_id) {
+    if (!use_buf_ring_) {
+        prepareProvideBuffers(buffer_id, 1);
+        return;
+    }
+    io_uring_buf *buf = &buf_ring_->bufs[buf_tail_ & (buf_count_ - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(getBuffer(buffer_id));
+    buf->len = buf_size_;
+    buf->bid = buffer_id;
+    buf_tail_++;
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+void IoUringLoop::prepareMultishotAccept(int fd, uint64_t user_data) {
+    io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = user_data;
+}
+
+void IoUringLoop::prepareMultishotRecv(int fd, uint64_t user_data) {
+    io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buf_group_;
+    sqe->user_data = user_data;
+}
+
+void IoUringLoop::prepareSendMsg(int fd, const msghdr *msg, uint64_t user_data, int flags) {
+    io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL | flags;
+    sqe->user_data = user_data;
+}
+
+void IoUringLoop::preparePollOut(int fd, uint64_t user_data) {
+    io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLOUT;
+    sqe->user_data = user_data;
+}
+
+void IoUringLoop::prepareCancel(uint64_t target) {
+    io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    sqe->user_data = CANCEL_USER_DATA;
+}
+
+int IoUringLoop::submitAndWait() {
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    int ret = enter(to_submit_, 1, IORING_ENTER_GETEVENTS);
+    if (ret >= 0) {
+        to_submit_ -= static_cast<unsigned>(ret);
+    }
+    return ret;
+}
+
+unsigned IoUringLoop::processCompletions() {
+    unsigned count = 0;
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        io_uring_cqe cqe = cqes_[head & *cq_mask_];
+        head++;
+        count++;
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        if (cqe.user_data == WAKEUP_USER_DATA) {
+            prepareWakeupRead();
+        } else if (cqe.user_data == INTERNAL_USER_DATA) {
+            if (cqe.res < 0) {
+                LOG_ERROR("io_uring internal request failed: %s", strerror(-cqe.res));
+            }
+        } else if (cqe.user_data == TIMER_USER_DATA) {
+            // 到期 (-ETIME) 后由 loop 按时间轮是否为空决定是否再挂
+            timer_armed_ = false;
+        } else if (cqe.user_data == CANCEL_USER_DATA) {
+            // 目标请求可能已经结束 (-ENOENT / -EALREADY)，结果由被取消的请求自己报告
+        } else if (completion_callback_) {
+            completion_callback_(cqe);
+        }
+        tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    }
+    return count;
+}
+
+void IoUringLoop::prepareProvideBuffers(uint16_t first_id, unsigned count) {
+    io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = static_cast<int>(count);
+    sqe->addr = reinterpret_cast<uint64_t>(getBuffer(first_id));
+    sqe->len = buf_size_;
+    sqe->off = first_id;
+    sqe->buf_group = buf_group_;
+    sqe->user_data = INTERNAL_USER_DATA;
+}
+
+void IoUringLoop::prepareWakeupRead() {
+    io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeup_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeup_value_);
+    sqe->len = sizeof(wakeup_value_);
+    sqe->user_data = WAKEUP_USER_DATA;
+}
+
+void IoUringLoop::prepareTimer() {
+    int millis = timers_.timeoutMillis(TimingWheel::Clock::now());
+    timer_spec_.tv_sec = millis / 1000;
+    timer_spec_.tv_nsec = static_cast<long long>(millis % 1000) * 1000000;
+    io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&timer_spec_);
+    sqe->len = 1;
+    sqe->user_data = TIMER_USER_DATA;
+    timer_armed_ = true;
+}
+
+io_uring_sqe *IoUringLoop::getSqe() {
+    // SQ 已满时先把已准备的 SQE 提交出去
+    while (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+        __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+        int ret = enter(to_submit_, 0, 0);
+        if (ret > 0) {
+            to_submit_ -= static_cast<unsigned>(ret);
+        } else if (ret < 0 && ret != -EAGAIN && ret != -EBUSY) {
+            LOG_ERROR("io_uring_enter failed: %s", strerror(-ret));
+        }
+    }
+
+    unsigned index = sq_local_tail_ & *sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    sq_local_tail_++;
+    to_submit_++;
+    return sqe;
+}
+
+int IoUringLoop::enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    while (true) {
+        int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete,
+                                           flags, nullptr, 0));
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        return ret < 0 ? -errno : ret;
+    }
+}
@@ -6,16 +6,19 @@
 #include "http_response.h"
 #include <string>
 #include <functional>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
 
 using RequestHandler = std::function<HttpResponse(const HttpRequest&, const std::unordered_map<std::string, std::string>&)>;
+// 流式路由：请求头到达后创建请求体 sink，请求体结束后处理器通过 request.getBodySink() 取回它生成响应
+using BodySinkFactory = std::function<std::unique_ptr<RequestBodySink>(const HttpRequest&, const std::unordered_map<std::string, std::string>&)>;
 
 
 class Route {
 public:
-    Route(std::string path, HttpMethod method, RequestHandler handler);
+    Route(std::string path, HttpMethod method, RequestHandler handler, BodySinkFactory bodySinkFactory = nullptr);
     ~Route() = default;
 
     // 禁用拷贝构造和赋值操作符
@@ -29,6 +32,7 @@ public:
     bool matches(const std::vector<std::string>& pathSegments, HttpMethod method) const;
     std::unordered_map<std::string, std::string> extractParams(const std::vector<std::string>& pathSegments) const;
     const RequestHandler& getHandler() const;
+    const BodySinkFactory& getBodySinkFactory() const;
 
     const std::string& getPath() const;
     HttpMethod getMethod() const;
@@ -42,6 +46,7 @@ private:
     std::string path_;
     HttpMethod method_;
     RequestHandler handler_;
+    BodySinkFactory bodySinkFactory_;
     std::vector<PathSegment> segments_;
 
     void parsePathSegments();
@@ -3,7 +3,8 @@
 
 #include <sstream>
 
-Route::Route(std::string path, HttpMethod method, RequestHandler handler) : path_(std::move(path)), method_(method), handler_(std::move(handler)) { parsePathSegments(); }
+Route::Route(std::string path, HttpMethod method, RequestHandler handler, BodySinkFactory bodySinkFactory)
+    : path_(std::move(path)), method_(method), handler_(std::move(handler)), bodySinkFactory_(std::move(bodySinkFactory)) { parsePathSegments(); }
 
 bool Route::matches(const std::vector<std::string> &pathSegments, HttpMethod method) const {
     if (method_ != method || pathSegments.size() != segments_.size()) {
@@ -29,6 +30,8 @@ std::unordered_map<std::string, std::string> Route::extractParams(const std::vec
 
 const RequestHandler &Route::getHandler() const { return handler_; }
 
+const BodySinkFactory &Route::getBodySinkFactory() const { return bodySinkFactory_; }
+
 const std::string &Route::getPath() const { return path_; }
 
 HttpMethod Route::getMethod() const { return method_; }
@@ -21,7 +21,7 @@ public:
     Router(Router&&) noexcept = default;
     Router& operator=(Router&&) noexcept = default;
 
-    void addRoute(const std::string& path, HttpMethod method, RequestHandler handler);
+    void addRoute(const std::string& path, HttpMethod method, RequestHandler handler, BodySinkFactory bodySinkFactory = nullptr);
     std::pair<const Route*, std::unordered_map<std::string, std::string>> 
     matchRoute(const HttpRequest& request) const;
 
@@ -4,8 +4,8 @@
 
 Router::Router() = default;
 
-void Router::addRoute(const std::string& path, HttpMethod method, RequestHandler handler) {
-    routes_.emplace_back(std::make_unique<Route>(path, method, std::move(handler)));
+void Router::addRoute(const std::string& path, HttpMethod method, RequestHandler handler, BodySinkFactory bodySinkFactory) {
+    routes_.emplace_back(std::make_unique<Route>(path, method, std::move(handler), std::move(bodySinkFactory)));
     updateTrie(routes_.back().get());
 }
 
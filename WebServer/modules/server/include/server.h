@@ -5,15 +5,22 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <functional>
+#include <future>
 #include <memory>
-#include <mutex>
-#include <unordered_map>
+#include <thread>
+#include <vector>
 
-#include "message_queue.h"
+#include "connection_table.h"
+#include "event_loop.h"
+#include "io_uring_loop.h"
 #include "thread_pool.h"
 #include "router.h"
 #include "static_file_controller.h"
+#include "response_compressor.h"
 
 class IServer {
 public:
@@ -21,34 +28,133 @@ public:
     virtual void run() = 0;
 };
 
+// 服务器并发模型
+enum class ServerMode {
+    REACTOR,        // 单 epoll 循环 + 线程池读写
+    MULTI_REACTOR,  // 主 Reactor accept + 每线程一个子 Reactor
+    REUSEPORT       // 每线程独立 SO_REUSEPORT 监听 + 独立 epoll，不共享任何状态
+};
+
+// I/O 后端
+enum class IoBackend {
+    EPOLL,      // 就绪通知 + read/send
+    IO_URING    // 完成通知：multishot accept/recv + 批量提交 send
+};
+
 class Server : public IServer {
 public:
     Server(int port, std::string& publicDirectory, int threadPoolSize);
+    ~Server() override;
     void run() override;
+    // 从其他线程让 run() 返回，分片线程在析构时退出
+    void stop();
     void registerHandler(HttpMethod method, const std::string &path, RequestHandler handler);
+    // 流式上传：请求体边到达边交给 bodySinkFactory 创建的 sink，结束后调用 handler
+    void registerStreamingHandler(HttpMethod method, const std::string &path, BodySinkFactory bodySinkFactory,
+                                  RequestHandler handler);
 
 private:
-    static constexpr std::size_t MAX_EVENTS = 2048;
-    static constexpr std::size_t BUFFER_SIZE = 8192; // 8KB
+    static constexpr unsigned URING_ENTRIES = 4096;
+    static constexpr unsigned URING_BUFFER_COUNT = 512;  // 必须是 2 的幂
+    static constexpr unsigned URING_BUFFER_SIZE = 8192;  // 8KB
+    static constexpr uint16_t URING_BUFFER_GROUP = 0;
+
+    // 交给线程池并行生成响应的流水线请求；线程池任务和按顺序等待它的线程谁先认领谁生成
+    struct PipelinedRequest {
+        HttpRequestPtr request;
+        std::atomic<bool> claimed{false};
+        std::promise<HttpResponse> response;
+    };
+
+    // SO_REUSEPORT 分片：独立监听 socket、事件循环、连接表与路由，静态文件控制器和压缩缓存与 primary 共用
+    Server(int port, const Server &primary);
 
     int server_fd;
-    int epoll_fd;
+    ServerMode mode;
+    IoBackend backend = IoBackend::EPOLL;
+    std::unique_ptr<IoUringLoop> ring;
+    std::unique_ptr<EventLoop> mainLoop;
+    std::vector<std::unique_ptr<EventLoop>> subLoops;
+    std::vector<std::thread> loopThreads;
+    std::vector<std::unique_ptr<Server>> shards;
+    std::size_t nextLoop = 0;
     std::unique_ptr<ThreadPool> pool;
-    std::unordered_map<int, std::unique_ptr<MessageQueue>> clients;
-    std::mutex clients_mutex;
+    ConnectionTable connections;
     Router router;
-    std::unique_ptr<StaticFileController> staticFileController;
+    std::shared_ptr<StaticFileController> staticFileController;
+    std::shared_ptr<ResponseCompressor> compressor;
     std::string publicDirectory;
+    std::size_t bodySpillThreshold = 0;
+    std::string bodySpillDirectory;
+    // 待发送输出超过高水位时暂停读取和解析，降到低水位以下再恢复；高水位为 0 表示不限制
+    std::size_t outputHighWatermark = 0;
+    std::size_t outputLowWatermark = 0;
+    // 连接超时，0 表示不限制
+    std::chrono::seconds keepAliveTimeout{0};
+    std::chrono::seconds headerTimeout{0};
+    std::chrono::seconds bodyTimeout{0};
+    std::chrono::seconds writeTimeout{0};
+    // 一个持久连接上最多处理的请求数，0 表示不限制
+    std::size_t keepAliveRequests = 0;
+    // 同一连接上流水线请求最多并行生成响应的个数，1 表示逐个处理；只在有线程池时生效
+    std::size_t pipelineDepth = 1;
 
     void initializeServer(int port, std::string& publicDirectory, int threadPoolSize);
+    void initializeListener(int port, bool reusePort);
+    void initializeStaticFiles(const std::string &publicDirectory);
+    void loadBodyOptions();
+    void startSubLoops(int count);
+    EventLoop &getNextLoop();
+    std::shared_ptr<Connection> createConnection(int client_fd);
     void handleNewConnection();
-    void handleClientEvent(epoll_event &event);
-    void handleRead(int client_fd);
-    void handleWrite(int client_fd);
-    void removeClient(int client_fd);
-    void modifyEpollEvent(int fd, uint32_t events);
-    
+    void handleClientEvent(EventLoop &loop, epoll_event &event);
+    void handleRead(EventLoop &loop, const std::shared_ptr<Connection> &connection);
+    void handleWrite(EventLoop &loop, const std::shared_ptr<Connection> &connection);
+    void readClient(EventLoop &loop, Connection &connection);
+    bool writeClient(EventLoop &loop, Connection &connection);
+    // 发送输出链队首：内存块用 send，文件块用 sendfile；返回值和 errno 语义同 send
+    ssize_t sendOutput(Connection &connection);
+    // 恢复被输出积压暂停的读取，先处理已经解析好的请求
+    void resumeReading(EventLoop &loop, Connection &connection);
+    void removeClient(EventLoop &loop, Connection &connection);
+    void modifyEpollEvent(EventLoop &loop, int fd, uint32_t events);
+
+    using TimeoutHandler = std::function<void(Connection &)>;
+    // 读写之后按连接当前的阶段推后 deadline；返回 true 表示新的 deadline 早于已挂的定时器，需要重新挂
+    bool refreshDeadline(Connection &connection);
+    // 在循环线程中按连接的 deadline 重新挂定时器，到期且期间没有读写时调用 onTimeout
+    void armTimeout(TimingWheel &timers, const std::shared_ptr<Connection> &connection, TimeoutHandler onTimeout);
+    // epoll 后端：读写之后更新超时，必要时投递到循环线程重新挂定时器
+    void updateTimeout(EventLoop &loop, const std::shared_ptr<Connection> &connection);
+    void armEpollTimeout(EventLoop &loop, const std::shared_ptr<Connection> &connection);
+
+    bool initializeIoUring();
+    void handleUringCompletion(const io_uring_cqe &cqe);
+    void handleUringAccept(const io_uring_cqe &cqe);
+    void handleUringRecv(int client_fd, const io_uring_cqe &cqe);
+    void handleUringSend(int client_fd, const io_uring_cqe &cqe);
+    void handleUringPollOut(int client_fd);
+    void flushUring(Connection &connection);
+    // 处理已解析的请求，必要时暂停接收或回复 400；hadError 为本次解析之前解析器是否已出错
+    void dispatchUringRequests(Connection &connection, bool hadError);
+    void armUringRecv(Connection &connection);
+    void armUringTimeout(const std::shared_ptr<Connection> &connection);
+    // 出错或超时：关闭 socket 两个方向并丢弃输出，由接收路径在 EOF 时统一关闭；有发送在途时等它以错误完成
+    void abortUring(Connection &connection);
+    void closeUring(int client_fd);
+
     HttpResponse generateResponse(const HttpRequest &request);
+    // count 为包括本次在内连接上已处理的请求数；返回响应之后是否保持连接
+    bool negotiateKeepAlive(const HttpRequest &request, const HttpResponse &response, std::size_t count) const;
+    // Keep-Alive 头的值：空闲超时和剩余请求数
+    std::string keepAliveParameters(std::size_t count) const;
+    // 协商持久连接并写入 Connection/Keep-Alive 头，序列化响应放入输出链，流式响应体挂在其后按需生成；
+    // 返回 true 表示响应结束后必须关闭连接
+    bool queueResponse(Connection &connection, const HttpRequest &request, HttpResponse response);
+    // 依次处理已解析的请求直到输出超过高水位或连接不再保持；返回 true 表示最后一个响应结束后必须关闭连接
+    bool processRequests(Connection &connection);
+    // 取出队首起连续的最多 pipelineDepth 个幂等请求并行生成响应，按请求顺序放入输出链；返回值同 queueResponse
+    bool queuePipelined(Connection &connection);
     void addCommonHeaders(HttpResponse &response);
     std::string getCurrentDate() const;
 };
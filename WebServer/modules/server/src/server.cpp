@@ -5,25 +5,177 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <iomanip>
 #include <sstream>
 
+// io_uring user_data 编码：高 32 位为操作类型，低 32 位为 fd
+enum class UringOp : uint64_t {
+    ACCEPT = 1,
+    RECV = 2,
+    SEND = 3,
+    POLL_OUT = 4    // 文件块遇到 EAGAIN 后等待 socket 可写
+};
+
+static uint64_t uringUserData(UringOp op, int fd) {
+    return (static_cast<uint64_t>(op) << 32) | static_cast<uint32_t>(fd);
+}
+
+// 超时为 0 时不限制
+static Connection::Clock::time_point deadlineAfter(std::chrono::seconds timeout) {
+    if (timeout.count() <= 0) {
+        return Connection::Clock::time_point::max();
+    }
+    return Connection::Clock::now() + timeout;
+}
+
+// Connection 头是逗号分隔、大小写不敏感的选项列表
+static bool hasConnectionOption(const std::string &header, std::string_view option) {
+    std::size_t start = 0;
+    while (start <= header.size()) {
+        std::size_t end = std::min(header.find(',', start), header.size());
+        if (equals_ignore_case(trim_ows(std::string_view(header.data() + start, end - start)), option)) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+// 幂等且无副作用的请求才能和后面的流水线请求并行处理；HEAD 的响应体在 queueResponse 中丢弃，与串行路径相同
+static bool isSafeMethod(HttpMethod method) {
+    return method == HttpMethod::GET || method == HttpMethod::HEAD || method == HttpMethod::OPTIONS;
+}
+
+static const char *timeoutPhaseName(TimeoutPhase phase) {
+    switch (phase) {
+        case TimeoutPhase::HEADER: return "header";
+        case TimeoutPhase::BODY: return "body";
+        case TimeoutPhase::IDLE: return "keep-alive";
+        case TimeoutPhase::WRITE: return "write";
+    }
+    return "unknown";
+}
+
 Server::Server(int port, std::string& publicDirectory, int threadPoolSize) {
     initializeServer(port, publicDirectory, threadPoolSize);
 }
 
+Server::Server(int port, const Server &primary)
+    : mode(primary.mode),
+      backend(primary.backend),
+      staticFileController(primary.staticFileController),
+      compressor(primary.compressor),
+      publicDirectory(primary.publicDirectory) {
+    initializeListener(port, true);
+    if (backend == IoBackend::IO_URING && !initializeIoUring()) {
+        backend = IoBackend::EPOLL;
+    }
+    loadBodyOptions();
+}
+
+Server::~Server() {
+    for (auto &loop : subLoops) {
+        loop->quit();
+    }
+    for (auto &shard : shards) {
+        shard->mainLoop->quit();
+        if (shard->ring) {
+            shard->ring->quit();
+        }
+    }
+    for (auto &thread : loopThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    close(server_fd);
+}
+
 void Server::initializeServer(int port, std::string& publicDirectory, int threadPoolSize) {
+    // sendfile 没有 MSG_NOSIGNAL，对端已关闭或连接已 shutdown 时写入会收到 SIGPIPE，按 EPIPE 处理
+    signal(SIGPIPE, SIG_IGN);
+    auto &config = ConfigManager::getInstance();
+    std::string modeName = config.getServerMode();
+    if (modeName == "multi_reactor") {
+        mode = ServerMode::MULTI_REACTOR;
+    } else if (modeName == "reuseport") {
+        mode = ServerMode::REUSEPORT;
+    } else {
+        if (modeName != "reactor") {
+            LOG_WARN("Unknown server mode '%s', defaulting to reactor", modeName.c_str());
+        }
+        mode = ServerMode::REACTOR;
+    }
+
+    std::string backendName = config.getIoBackend();
+    if (backendName == "io_uring") {
+        backend = IoBackend::IO_URING;
+        if (mode == ServerMode::MULTI_REACTOR) {
+            // io_uring 每个监听 socket 一个 ring，多线程时按 reuseport 分片
+            LOG_WARN("io_uring backend does not support multi_reactor, using reuseport");
+            mode = ServerMode::REUSEPORT;
+        }
+    } else if (backendName != "epoll") {
+        LOG_WARN("Unknown io backend '%s', defaulting to epoll", backendName.c_str());
+    }
+
+    initializeListener(port, mode == ServerMode::REUSEPORT);
+    if (backend == IoBackend::IO_URING && !initializeIoUring()) {
+        backend = IoBackend::EPOLL;
+    }
+    initializeStaticFiles(publicDirectory);
+    loadBodyOptions();
+
+    int loopCount = config.getEventLoopThreads();
+    if (loopCount <= 0) {
+        loopCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    switch (mode) {
+        case ServerMode::MULTI_REACTOR:
+            startSubLoops(loopCount);
+            LOG_INFO("Server initialized on port %d with %d event loops", port, loopCount);
+            break;
+        case ServerMode::REUSEPORT:
+            // 当前对象自己就是第 0 个分片，其余分片在 run() 时各起一个线程
+            for (int i = 1; i < loopCount; i++) {
+                shards.push_back(std::unique_ptr<Server>(new Server(port, *this)));
+            }
+            LOG_INFO("Server initialized on port %d with %d SO_REUSEPORT listeners", port, loopCount);
+            break;
+        case ServerMode::REACTOR:
+            if (backend == IoBackend::IO_URING) {
+                LOG_INFO("Server initialized on port %d with io_uring backend", port);
+                break;
+            }
+            pool = std::make_unique<ThreadPool>(threadPoolSize);
+            LOG_INFO("Server initialized on port %d with %d threads", port, config.getThreadPoolSize());
+            break;
+    }
+}
+
+void Server::initializeListener(int port, bool reusePort) {
     server_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (server_fd < 0) {
         LOG_FATAL("Socket creation failed");
         throw std::runtime_error("Socket creation failed");
     }
 
+    int optval = 1;
+    if (reusePort && setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0) {
+        close(server_fd);
+        LOG_FATAL("setsockopt SO_REUSEPORT failed: %s", strerror(errno));
+        throw std::runtime_error("setsockopt SO_REUSEPORT failed");
+    }
+
     sockaddr_in server_addr;
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
@@ -41,58 +193,151 @@ void Server::initializeServer(int port, std::string& publicDirectory, int thread
         throw std::runtime_error("Listen failed");
     }
 
-    epoll_fd = epoll_create1(0);
-    if (epoll_fd < 0) {
+    try {
+        mainLoop = std::make_unique<EventLoop>();
+    } catch (...) {
         close(server_fd);
-        LOG_FATAL("epoll_create1 failed");
-        throw std::runtime_error("epoll_create1 failed");
+        throw;
     }
 
-    epoll_event event;
-    event.data.fd = server_fd;
-    event.events = EPOLLIN | EPOLLET;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_fd, &event) < 0) {
+    if (!mainLoop->addFd(server_fd, EPOLLIN | EPOLLET)) {
         close(server_fd);
-        close(epoll_fd);
         LOG_FATAL("epoll_ctl failed");
         throw std::runtime_error("epoll_ctl failed");
     }
+}
 
+void Server::initializeStaticFiles(const std::string &publicDirectory) {
     auto &config = ConfigManager::getInstance();
     this->publicDirectory = publicDirectory;
-    pool = std::make_unique<ThreadPool>(threadPoolSize);
-    staticFileController = std::make_unique<StaticFileController>(publicDirectory);
+    StaticFileOptions options;
+    options.openFileCacheMax = config.getOpenFileCacheMax();
+    options.openFileCacheValid = std::chrono::seconds(config.getOpenFileCacheValid());
+    options.contentCacheSize = config.getContentCacheSize();
+    options.contentCacheMaxObject = config.getContentCacheMaxObject();
+    options.contentCacheMinUses = config.getContentCacheMinUses();
+    options.watchFiles = config.getStaticFileWatch();
+    options.precompressed = config.getStaticPrecompressed();
 
-    LOG_INFO("Server initialized on port %d with %d threads", port, config.getThreadPoolSize());
+    CompressionOptions compression;
+    compression.enabled = config.getCompression();
+    compression.level = config.getCompressionLevel();
+    compression.minLength = config.getCompressionMinLength();
+    compression.maxLength = config.getCompressionMaxLength();
+    compression.inlineLength = config.getCompressionInlineLength();
+    compression.cacheSize = config.getCompressionCacheSize();
+    if (auto types = config.getCompressionTypes(); !types.empty()) {
+        compression.mimeTypes = std::move(types);
+    }
+    // reuseport 分片共用同一个控制器：缓存按配置的总预算只占一份，文件监视线程也只有一个
+    compressor = compression.enabled ? std::make_shared<ResponseCompressor>(compression) : nullptr;
+    staticFileController = std::make_shared<StaticFileController>(publicDirectory, options, compressor);
 }
 
-void Server::run() {
-    LOG_INFO("Server starting...");
-    std::vector<epoll_event> events(MAX_EVENTS);
+void Server::loadBodyOptions() {
+    auto &config = ConfigManager::getInstance();
+    bodySpillThreshold = config.getBodySpillThreshold();
+    bodySpillDirectory = config.getBodySpillDirectory();
+    outputHighWatermark = config.getOutputHighWatermark();
+    // 低水位不低于高水位时没有滞回区间，退化为高水位本身
+    outputLowWatermark = std::min(config.getOutputLowWatermark(), outputHighWatermark);
+    keepAliveTimeout = std::chrono::seconds(std::max(0, config.getKeepAliveTimeout()));
+    headerTimeout = std::chrono::seconds(std::max(0, config.getHeaderTimeout()));
+    bodyTimeout = std::chrono::seconds(std::max(0, config.getBodyTimeout()));
+    writeTimeout = std::chrono::seconds(std::max(0, config.getWriteTimeout()));
+    keepAliveRequests = config.getKeepAliveRequests();
+    pipelineDepth = std::max<std::size_t>(1, config.getPipelineDepth());
+}
 
-    while (true) {
-        int event_count = epoll_wait(epoll_fd, events.data(), MAX_EVENTS, -1);
+void Server::startSubLoops(int count) {
+    for (int i = 0; i < count; i++) {
+        auto loop = std::make_unique<EventLoop>();
+        EventLoop *raw = loop.get();
+        raw->setEventCallback([this, raw](epoll_event &event) {
+            handleClientEvent(*raw, event);
+        });
+        subLoops.push_back(std::move(loop));
+    }
+    for (auto &loop : subLoops) {
+        loopThreads.emplace_back([raw = loop.get()] {
+            raw->loop();
+        });
+    }
+}
 
-        if (event_count < 0) {
-            LOG_ERROR("epoll_wait failed: %s", strerror(errno));
-            break;
-        }
+EventLoop &Server::getNextLoop() {
+    EventLoop &loop = *subLoops[nextLoop];
+    nextLoop = (nextLoop + 1) % subLoops.size();
+    return loop;
+}
 
-        for (int i = 0; i < event_count; i++) {
-            if (events[i].data.fd == server_fd) {
-                handleNewConnection();
-            } else {
-                handleClientEvent(events[i]);
-            }
+void Server::run() {
+    LOG_INFO("Server starting...");
+    for (auto &shard : shards) {
+        loopThreads.emplace_back([raw = shard.get()] {
+            raw->run();
+        });
+    }
+    if (backend == IoBackend::IO_URING) {
+        ring->setCompletionCallback([this](const io_uring_cqe &cqe) {
+            handleUringCompletion(cqe);
+        });
+        ring->prepareMultishotAccept(server_fd, uringUserData(UringOp::ACCEPT, server_fd));
+        ring->loop();
+        return;
+    }
+    mainLoop->setEventCallback([this](epoll_event &event) {
+        if (event.data.fd == server_fd) {
+            handleNewConnection();
+        } else {
+            handleClientEvent(*mainLoop, event);
         }
+    });
+    mainLoop->loop();
+}
+
+void Server::stop() {
+    if (ring) {
+        ring->quit();
     }
+    mainLoop->quit();
 }
 
 void Server::registerHandler(HttpMethod method, const std::string &path, RequestHandler handler) {
+    // 每个分片持有自己的路由表副本，运行期不跨线程共享
+    for (auto &shard : shards) {
+        shard->registerHandler(method, path, handler);
+    }
     router.addRoute(path, method, std::move(handler));
     LOG_DEBUG("Registered handler for method %d, path %s", static_cast<int>(method), path.c_str());
 }
 
+void Server::registerStreamingHandler(HttpMethod method, const std::string &path, BodySinkFactory bodySinkFactory,
+                                      RequestHandler handler) {
+    for (auto &shard : shards) {
+        shard->registerStreamingHandler(method, path, bodySinkFactory, handler);
+    }
+    router.addRoute(path, method, std::move(handler), std::move(bodySinkFactory));
+    LOG_DEBUG("Registered streaming handler for method %d, path %s", static_cast<int>(method), path.c_str());
+}
+
+std::shared_ptr<Connection> Server::createConnection(int client_fd) {
+    auto connection = std::make_shared<Connection>(client_fd);
+    HttpParser &parser = connection->parser();
+    parser.setBodySpill(bodySpillThreshold, bodySpillDirectory);
+    // 请求头到达时就匹配路由，流式路由的请求体不经过内存缓冲
+    parser.setBodySinkFactory([this](const HttpRequest &request) -> std::unique_ptr<RequestBodySink> {
+        auto [route, params] = router.matchRoute(request);
+        if (!route || !route->getBodySinkFactory()) {
+            return nullptr;
+        }
+        return route->getBodySinkFactory()(request, params);
+    });
+    // 新连接等待第一个请求，按请求头超时计算
+    connection->setDeadline(TimeoutPhase::HEADER, deadlineAfter(headerTimeout));
+    return connection;
+}
+
 void Server::handleNewConnection() {
     while (true) {
         sockaddr_in client_addr;
@@ -111,23 +356,31 @@ void Server::handleNewConnection() {
         inet_ntop(AF_INET, &(client_addr.sin_addr), client_ip, INET_ADDRSTRLEN);
         LOG_INFO("New connection from %s:%d", client_ip, ntohs(client_addr.sin_port));
 
-        epoll_event event;
-        event.data.fd = client_fd;
-        event.events = EPOLLIN | EPOLLET;
-        int epoll_ctl_result = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &event);
-        if (epoll_ctl_result < 0) {
-            LOG_ERROR("epoll_ctl failed for client socket: %s", strerror(errno));
-            close(client_fd);
-        } else {
-            std::lock_guard<std::mutex> lock(clients_mutex);
-            clients[client_fd] = std::make_unique<MessageQueue>();
-            LOG_DEBUG("Client %d added to epoll", client_fd);
-        }
+        // 多 Reactor 模式下连接交给子 Reactor，此后槽位和读写都只在该线程访问
+        auto connection = createConnection(client_fd);
+        EventLoop &loop = (mode == ServerMode::MULTI_REACTOR) ? getNextLoop() : *mainLoop;
+        loop.runInLoop([this, &loop, connection] {
+            int fd = connection->fd();
+            if (!connections.insert(connection)) {
+                return;
+            }
+            if (!loop.addFd(fd, EPOLLIN | EPOLLET)) {
+                LOG_ERROR("epoll_ctl failed for client socket %d", fd);
+                connections.erase(fd);
+            } else {
+                LOG_DEBUG("Client %d added to epoll", fd);
+                armEpollTimeout(loop, connection);
+            }
+        });
     }
 }
 
-void Server::handleClientEvent(epoll_event &event) {
+void Server::handleClientEvent(EventLoop &loop, epoll_event &event) {
     int client_fd = event.data.fd;
+    std::shared_ptr<Connection> connection = connections.find(client_fd);
+    if (!connection) {
+        return;
+    }
     if (event.events & (EPOLLERR | EPOLLHUP)) {
         if (event.events & EPOLLERR) {
             LOG_ERROR("Error event for client %d", client_fd);
@@ -135,132 +388,733 @@ void Server::handleClientEvent(epoll_event &event) {
         if (event.events & EPOLLHUP) {
             LOG_INFO("Hangup event for client %d", client_fd);
         }
-        removeClient(client_fd);
+        if (mode == ServerMode::REACTOR) {
+            std::lock_guard<std::mutex> lock(connection->mutex());
+            removeClient(loop, *connection);
+        } else {
+            removeClient(loop, *connection);
+        }
     } else {
         if (event.events & EPOLLIN) {
             LOG_DEBUG("Read event for client %d", client_fd);
-            handleRead(client_fd);
+            handleRead(loop, connection);
         }
         if (event.events & EPOLLOUT) {
             LOG_DEBUG("Write event for client %d", client_fd);
-            handleWrite(client_fd);
+            handleWrite(loop, connection);
         }
     }
 }
 
-void Server::handleRead(int client_fd) {
-    pool->enqueue([this, client_fd] {
-        std::vector<char> buffer(BUFFER_SIZE);
-        HttpParser parser;
-        bool keep_alive = true;
+void Server::handleRead(EventLoop &loop, const std::shared_ptr<Connection> &connection) {
+    if (mode != ServerMode::REACTOR) {
+        readClient(loop, *connection);
+        updateTimeout(loop, connection);
+        return;
+    }
+    // 任务持有连接的引用，同一连接的读写任务由连接自己的锁串行化
+    pool->enqueue([this, &loop, connection] {
+        std::lock_guard<std::mutex> lock(connection->mutex());
+        readClient(loop, *connection);
+        updateTimeout(loop, connection);
+    });
+}
 
-        while (keep_alive) {
-            ssize_t bytes_read = read(client_fd, buffer.data(), buffer.size());
-            if (bytes_read < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    break;
-                } else {
-                    LOG_ERROR("Read failed on socket %d: %s", client_fd, strerror(errno));
-                    removeClient(client_fd);
-                    return;
-                }
-            } else if (bytes_read == 0) {
-                LOG_INFO("Client disconnected: %d", client_fd);
-                removeClient(client_fd);
+void Server::handleWrite(EventLoop &loop, const std::shared_ptr<Connection> &connection) {
+    if (mode != ServerMode::REACTOR) {
+        writeClient(loop, *connection);
+        updateTimeout(loop, connection);
+        return;
+    }
+    pool->enqueue([this, &loop, connection] {
+        std::lock_guard<std::mutex> lock(connection->mutex());
+        writeClient(loop, *connection);
+        updateTimeout(loop, connection);
+    });
+}
+
+void Server::readClient(EventLoop &loop, Connection &connection) {
+    int client_fd = connection.fd();
+    std::vector<char> &buffer = connection.inputBuffer();
+    HttpParser &parser = connection.parser();
+
+    // 暂停期间排队的读事件直接忽略，恢复时重新登记 EPOLLIN
+    while (connection.isConnected() && !connection.isReadPaused()) {
+        ssize_t bytes_read = read(client_fd, buffer.data(), buffer.size());
+        if (bytes_read < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else {
+                LOG_ERROR("Read failed on socket %d: %s", client_fd, strerror(errno));
+                removeClient(loop, connection);
+                return;
+            }
+        } else if (bytes_read == 0) {
+            LOG_INFO("Client disconnected: %d", client_fd);
+            removeClient(loop, connection);
+            return;
+        }
+
+        parser.parse(buffer.data(), bytes_read);
+        if (processRequests(connection)) {
+            connection.setState(ConnectionState::CLOSING);
+        }
+        if (connection.isKeepAlive() && parser.hasError() && !parser.hasCompletedRequest()) {
+            // 解析器不会从错误中恢复，回复 400 后关闭连接
+            LOG_WARN("Malformed request on socket %d", client_fd);
+            connection.appendOutput(HttpResponse::makeBadRequestResponse().toString());
+            connection.setState(ConnectionState::CLOSING);
+        }
+        if (connection.isReadPaused()) {
+            // 输出积压：只监听 EPOLLOUT，socket 中后续的请求留在内核缓冲区，由 TCP 流控反压到客户端
+            LOG_DEBUG("Client %d has %zu bytes pending, pausing reads", client_fd, connection.pendingBytes());
+            connection.setWaitingWritable(true);
+            modifyEpollEvent(loop, client_fd, EPOLLOUT);
+            break;
+        }
+        if (mode != ServerMode::REACTOR) {
+            // 连接归属当前线程，直接写出，省去一次 EPOLLOUT 往返；正在等待可写时新响应留在输出链中一起发
+            if (!connection.isWaitingWritable() && !writeClient(loop, connection)) {
                 return;
             }
+        } else {
+            modifyEpollEvent(loop, client_fd, EPOLLIN | EPOLLOUT);
+        }
+    }
+}
+
+bool Server::writeClient(EventLoop &loop, Connection &connection) {
+    if (connection.state() == ConnectionState::CLOSED) {
+        return false;
+    }
 
-           parser.parse(buffer.data(), bytes_read);
-            while(parser.hasCompletedRequest()) {
-                auto request = parser.getCompletedRequest();
-                auto response = generateResponse(*request);
-                {
-                    std::lock_guard<std::mutex> lock(clients_mutex);
-                    if (clients.find(client_fd) != clients.end()) {
-                        clients[client_fd]->pushResponse(std::move(response));
-                    }
+    int client_fd = connection.fd();
+    std::size_t total_sent = 0;
+    while (true) {
+        if (!connection.prepareOutput()) {
+            LOG_ERROR("Response body producer failed for client %d", client_fd);
+            removeClient(loop, connection);
+            return false;
+        }
+        if (!connection.hasOutput()) {
+            break;
+        }
+        ssize_t sent = sendOutput(connection);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // 发送缓冲区已满：登记 EPOLLOUT 后返回，不在这里空转占住线程
+                // 未发完的部分留在输出链中，可写时由 handleWrite 从断点继续
+                // 边缘触发下已登记过就不必重复修改，socket 重新可写时内核会再通知一次
+                LOG_DEBUG("Client %d not writable after %zu bytes, waiting for EPOLLOUT", client_fd, total_sent);
+                if (!connection.isWaitingWritable()) {
+                    connection.setWaitingWritable(true);
+                    modifyEpollEvent(loop, client_fd, EPOLLIN | EPOLLOUT);
                 }
-                // Check if we should keep the connection alive
-                auto connection_header = request->getHeader("Connection");
-                keep_alive = (connection_header == "keep-alive");
+                return true;
+            } else {
+                LOG_ERROR("Send error to client %d: %s", client_fd, strerror(errno));
+                removeClient(loop, connection);
+                return false;
             }
-            modifyEpollEvent(client_fd, EPOLLIN | EPOLLOUT);
-            if (!keep_alive) {
-                break;
+        }
+        connection.consumeOutput(sent);
+        total_sent += sent;
+        if (connection.isReadPaused() && connection.pendingBytes() <= outputLowWatermark) {
+            resumeReading(loop, connection);
+        }
+    }
+    LOG_DEBUG("Sent response to client %d: %d bytes", client_fd, total_sent);
+
+    if (connection.state() == ConnectionState::CLOSING) {
+        removeClient(loop, connection);
+        return false;
+    }
+    // 输出链已发完，不再关心可写事件
+    if (mode == ServerMode::REACTOR || connection.isWaitingWritable()) {
+        connection.setWaitingWritable(false);
+        modifyEpollEvent(loop, client_fd, EPOLLIN);
+    }
+    return true;
+}
+
+bool Server::processRequests(Connection &connection) {
+    HttpParser &parser = connection.parser();
+    while (connection.isKeepAlive() && !connection.isReadPaused() && parser.hasCompletedRequest()) {
+        bool close;
+        if (pool && pipelineDepth > 1 && isSafeMethod(parser.peekCompletedRequest()->getMethod())) {
+            close = queuePipelined(connection);
+        } else {
+            auto request = parser.getCompletedRequest();
+            close = queueResponse(connection, *request, generateResponse(*request));
+        }
+        if (close) {
+            // 这是连接上的最后一个响应，同一批中后续的流水线请求直接丢弃
+            connection.setKeepAlive(false);
+            return true;
+        }
+        if (outputHighWatermark > 0 && connection.pendingBytes() > outputHighWatermark) {
+            connection.setReadPaused(true);
+        }
+    }
+    return false;
+}
+
+bool Server::queuePipelined(Connection &connection) {
+    HttpParser &parser = connection.parser();
+    HttpRequestPtr first = parser.getCompletedRequest();
+    std::vector<std::shared_ptr<PipelinedRequest>> pending;
+    while (pending.size() + 1 < pipelineDepth) {
+        const HttpRequest *next = parser.peekCompletedRequest();
+        if (!next || !isSafeMethod(next->getMethod())) {
+            break;
+        }
+        auto pipelined = std::make_shared<PipelinedRequest>();
+        pipelined->request = parser.getCompletedRequest();
+        pool->enqueue([this, pipelined] {
+            if (!pipelined->claimed.exchange(true)) {
+                pipelined->response.set_value(generateResponse(*pipelined->request));
             }
+        });
+        pending.push_back(std::move(pipelined));
+    }
+
+    // 当前线程处理第一个请求，之后按顺序取结果；还没被工作线程认领的就地生成，不会等待排队中的任务
+    bool close = queueResponse(connection, *first, generateResponse(*first));
+    for (std::size_t i = 0; i < pending.size() && !close; i++) {
+        PipelinedRequest &pipelined = *pending[i];
+        HttpResponse response = pipelined.claimed.exchange(true) ? pipelined.response.get_future().get()
+                                                                 : generateResponse(*pipelined.request);
+        close = queueResponse(connection, *pipelined.request, std::move(response));
+    }
+    if (close) {
+        // 连接不再保持，还没开始的请求不再生成响应
+        for (auto &pipelined : pending) {
+            pipelined->claimed.store(true);
+        }
+    }
+    return close;
+}
+
+void Server::resumeReading(EventLoop &loop, Connection &connection) {
+    LOG_DEBUG("Client %d drained to %zu bytes, resuming reads", connection.fd(), connection.pendingBytes());
+    connection.setReadPaused(false);
+    if (processRequests(connection)) {
+        connection.setState(ConnectionState::CLOSING);
+    }
+    HttpParser &parser = connection.parser();
+    if (!connection.isReadPaused() && parser.hasError() && !parser.hasCompletedRequest() &&
+        connection.isConnected() && connection.isKeepAlive()) {
+        LOG_WARN("Malformed request on socket %d", connection.fd());
+        connection.appendOutput(HttpResponse::makeBadRequestResponse().toString());
+        connection.setState(ConnectionState::CLOSING);
+    }
+    if (!connection.isReadPaused() && connection.isConnected()) {
+        // 重新登记 EPOLLIN：暂停期间到达的数据会立即触发一次读事件；输出还没发完，EPOLLOUT 继续保留
+        modifyEpollEvent(loop, connection.fd(), EPOLLIN | EPOLLOUT);
+    }
+}
+
+void Server::removeClient(EventLoop &loop, Connection &connection) {
+    if (connection.state() == ConnectionState::CLOSED) {
+        return;
+    }
+    connection.setState(ConnectionState::CLOSED);
+
+    int client_fd = connection.fd();
+    loop.removeFd(client_fd);
+    // 槽位和定时器只在所属循环线程修改；调用方仍持有引用，fd 在最后一个引用释放时才关闭，不会被提前复用
+    loop.runInLoop([this, &loop, client_fd] {
+        if (auto connection = connections.find(client_fd)) {
+            loop.timers().cancel(connection->timerId());
         }
+        connections.erase(client_fd);
     });
+    LOG_INFO("Client %d removed", client_fd);
+}
+
+void Server::modifyEpollEvent(EventLoop &loop, int fd, uint32_t events) {
+    loop.modifyFd(fd, events | EPOLLET);
+}
+
+bool Server::refreshDeadline(Connection &connection) {
+    if (connection.state() == ConnectionState::CLOSED) {
+        return false;
+    }
+    TimeoutPhase phase;
+    std::chrono::seconds timeout;
+    if (connection.hasOutput()) {
+        phase = TimeoutPhase::WRITE;
+        timeout = writeTimeout;
+    } else {
+        switch (connection.parser().progress()) {
+            case HttpParser::Progress::HEADERS:
+                // 请求头超时从第一个字节算起，逐字节发送的慢速客户端不能一直推后
+                if (connection.timeoutPhase() == TimeoutPhase::HEADER) {
+                    return false;
+                }
+                phase = TimeoutPhase::HEADER;
+                timeout = headerTimeout;
+                break;
+            case HttpParser::Progress::BODY:
+                phase = TimeoutPhase::BODY;
+                timeout = bodyTimeout;
+                break;
+            default:
+                phase = TimeoutPhase::IDLE;
+                timeout = keepAliveTimeout;
+                break;
+        }
+    }
+    auto deadline = deadlineAfter(timeout);
+    connection.setDeadline(phase, deadline);
+    return deadline < connection.timerExpires();
 }
 
-void Server::handleWrite(int client_fd) {
-    pool->enqueue([this, client_fd] {
-        std::unique_ptr<MessageQueue>& queue = clients[client_fd];
-        if (!queue) {
+void Server::armTimeout(TimingWheel &timers, const std::shared_ptr<Connection> &connection, TimeoutHandler onTimeout) {
+    timers.cancel(connection->timerId());
+    auto deadline = connection->deadline();
+    if (connection->state() == ConnectionState::CLOSED || deadline == Connection::Clock::time_point::max()) {
+        connection->setTimer(0, Connection::Clock::time_point::max());
+        return;
+    }
+    auto delay = std::max(deadline - Connection::Clock::now(), Connection::Clock::duration::zero());
+    auto id = timers.add(delay, [this, &timers, weak = std::weak_ptr<Connection>(connection), onTimeout] {
+        auto connection = weak.lock();
+        if (!connection) {
             return;
         }
+        connection->setTimer(0, Connection::Clock::time_point::max());
+        // 线程池模式下工作线程可能正在处理该连接，拿不到锁就下一个 tick 再看
+        std::unique_lock<std::mutex> lock(connection->mutex(), std::defer_lock);
+        if (pool && !lock.try_lock()) {
+            armTimeout(timers, connection, onTimeout);
+            return;
+        }
+        if (connection->state() == ConnectionState::CLOSED) {
+            return;
+        }
+        if (Connection::Clock::now() < connection->deadline()) {
+            // 期间有读写，deadline 已被推后
+            armTimeout(timers, connection, onTimeout);
+            return;
+        }
+        LOG_INFO("Client %d %s timeout", connection->fd(), timeoutPhaseName(connection->timeoutPhase()));
+        onTimeout(*connection);
+    });
+    connection->setTimer(id, deadline);
+}
 
-        while (queue->hasResponses()) {
-            HttpResponse response = queue->popResponse();
-            std::string response_str = response.toString();
-
-            size_t total_sent = 0;
-            while (total_sent < response_str.length()) {
-                ssize_t sent = send(client_fd, response_str.c_str() + total_sent, 
-                                    response_str.length() - total_sent, 0);
-                if (sent < 0) {
-                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                        // 资源暂时不可用，稍后重试
-                        continue;
-                    } else {
-                        LOG_ERROR("Send error to client %d: %s", client_fd, strerror(errno));
-                        removeClient(client_fd);
-                        return;
-                    }
-                }
-                total_sent += sent;
-            }
+void Server::updateTimeout(EventLoop &loop, const std::shared_ptr<Connection> &connection) {
+    if (refreshDeadline(*connection)) {
+        loop.runInLoop([this, &loop, connection] {
+            armEpollTimeout(loop, connection);
+        });
+    }
+}
+
+void Server::armEpollTimeout(EventLoop &loop, const std::shared_ptr<Connection> &connection) {
+    armTimeout(loop.timers(), connection, [this, &loop](Connection &connection) {
+        removeClient(loop, connection);
+    });
+}
+
+bool Server::initializeIoUring() {
+    try {
+        ring = std::make_unique<IoUringLoop>(URING_ENTRIES);
+        ring->setupBufferRing(URING_BUFFER_GROUP, URING_BUFFER_COUNT, URING_BUFFER_SIZE);
+        return true;
+    } catch (const std::exception &e) {
+        LOG_WARN("io_uring unavailable (%s), falling back to epoll", e.what());
+        ring.reset();
+        return false;
+    }
+}
 
-            LOG_DEBUG("Sent response to client %d: %d bytes", client_fd, total_sent);
+void Server::handleUringCompletion(const io_uring_cqe &cqe) {
+    int fd = static_cast<int>(cqe.user_data & 0xffffffff);
+    switch (static_cast<UringOp>(cqe.user_data >> 32)) {
+        case UringOp::ACCEPT:
+            handleUringAccept(cqe);
+            break;
+        case UringOp::RECV:
+            handleUringRecv(fd, cqe);
+            break;
+        case UringOp::SEND:
+            handleUringSend(fd, cqe);
+            break;
+        case UringOp::POLL_OUT:
+            handleUringPollOut(fd);
+            break;
+    }
+}
+
+void Server::handleUringAccept(const io_uring_cqe &cqe) {
+    if (cqe.res >= 0) {
+        int client_fd = cqe.res;
+        auto connection = createConnection(client_fd);
+        if (connections.insert(connection)) {
+            armUringRecv(*connection);
+            armUringTimeout(connection);
+            LOG_DEBUG("Client %d accepted via io_uring", client_fd);
         }
+    } else {
+        LOG_ERROR("Accept failed: %s", strerror(-cqe.res));
+    }
+    // multishot 被内核终止时需要重新提交
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        ring->prepareMultishotAccept(server_fd, uringUserData(UringOp::ACCEPT, server_fd));
+    }
+}
 
-        modifyEpollEvent(client_fd, EPOLLIN);
+void Server::handleUringRecv(int client_fd, const io_uring_cqe &cqe) {
+    std::shared_ptr<Connection> connection = connections.find(client_fd);
+    if (cqe.res > 0 && connection) {
+        uint16_t buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        HttpParser &parser = connection->parser();
+        bool had_error = parser.hasError();
+        parser.parse(ring->getBuffer(buffer_id), cqe.res);
+        ring->recycleBuffer(buffer_id);
+        // 暂停期间取消生效之前仍可能收到数据，只解析不处理
+        if (!connection->isReadPaused()) {
+            dispatchUringRequests(*connection, had_error);
+        }
+        flushUring(*connection);
+        if (refreshDeadline(*connection)) {
+            armUringTimeout(connection);
+        }
+    } else if (cqe.flags & IORING_CQE_F_BUFFER) {
+        ring->recycleBuffer(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+    }
+
+    if (cqe.flags & IORING_CQE_F_MORE) {
+        return;
+    }
+    if (connection) {
+        connection->setReceiving(false);
+    }
+    if (cqe.res == -ECANCELED && connection) {
+        // 输出积压时主动取消的接收；取消完成前已经恢复的，现在重新挂上
+        if (!connection->isReadPaused()) {
+            armUringRecv(*connection);
+        }
+    } else if (cqe.res > 0 || cqe.res == -ENOBUFS) {
+        // 缓冲区耗尽或内核结束了 multishot，重新挂上接收；暂停中的连接等恢复时再挂
+        // 连接已经移除时 fd 已随 Connection 关闭，编号可能已被新连接复用，不能再挂也不能再关
+        if (!connection) {
+            LOG_DEBUG("Dropping recv completion for removed client %d", client_fd);
+        } else if (!connection->isReadPaused()) {
+            armUringRecv(*connection);
+        }
+    } else {
+        if (cqe.res < 0) {
+            LOG_ERROR("Read failed on socket %d: %s", client_fd, strerror(-cqe.res));
+        } else {
+            LOG_INFO("Client disconnected: %d", client_fd);
+        }
+        closeUring(client_fd);
+    }
+}
+
+void Server::dispatchUringRequests(Connection &connection, bool hadError) {
+    int client_fd = connection.fd();
+    if (processRequests(connection)) {
+        // 连接不再保持，不再接收后续请求；multishot recv 以 EOF 结束，由接收路径在响应发送完成后关闭
+        shutdown(client_fd, SHUT_RD);
+        return;
+    }
+    if (connection.isReadPaused()) {
+        // 输出积压：取消 multishot recv，后续请求留在内核缓冲区，由 TCP 流控反压到客户端
+        LOG_DEBUG("Client %d has %zu bytes pending, pausing reads", client_fd, connection.pendingBytes());
+        if (connection.isReceiving()) {
+            ring->prepareCancel(uringUserData(UringOp::RECV, client_fd));
+        }
+        return;
+    }
+    // 出错之前的请求都处理完后才回复 400
+    HttpParser &parser = connection.parser();
+    if (parser.hasError() && !hadError && connection.isKeepAlive()) {
+        LOG_WARN("Malformed request on socket %d", client_fd);
+        connection.appendOutput(HttpResponse::makeBadRequestResponse().toString());
+        // 让 multishot recv 以 EOF 结束，由接收路径在 400 发送完成后关闭
+        shutdown(client_fd, SHUT_RD);
+    }
+}
+
+void Server::armUringRecv(Connection &connection) {
+    connection.setReceiving(true);
+    ring->prepareMultishotRecv(connection.fd(), uringUserData(UringOp::RECV, connection.fd()));
+}
+
+void Server::armUringTimeout(const std::shared_ptr<Connection> &connection) {
+    armTimeout(ring->timers(), connection, [this](Connection &connection) {
+        abortUring(connection);
     });
 }
 
-void Server::removeClient(int client_fd) {
-    std::lock_guard<std::mutex> lock(clients_mutex);
-    clients.erase(client_fd);
+void Server::abortUring(Connection &connection) {
+    shutdown(connection.fd(), SHUT_RDWR);
+    if (connection.isSending()) {
+        return;
+    }
+    connection.clearOutput();
+    // 接收已暂停时重新挂上，让它读到 EOF
+    connection.setReadPaused(false);
+    if (!connection.isReceiving()) {
+        armUringRecv(connection);
+    }
+}
+
+void Server::handleUringSend(int client_fd, const io_uring_cqe &cqe) {
+    std::shared_ptr<Connection> connection = connections.find(client_fd);
+    if (!connection) {
+        return;
+    }
+    connection->setSending(false);
+    if (cqe.res < 0) {
+        LOG_ERROR("Send error to client %d: %s", client_fd, strerror(-cqe.res));
+        abortUring(*connection);
+    } else {
+        connection->consumeOutput(cqe.res);
+        LOG_DEBUG("Sent response to client %d: %d bytes", client_fd, cqe.res);
+        if (connection->isReadPaused() && connection->pendingBytes() <= outputLowWatermark) {
+            LOG_DEBUG("Client %d drained to %zu bytes, resuming reads", client_fd, connection->pendingBytes());
+            connection->setReadPaused(false);
+            dispatchUringRequests(*connection, false);
+            if (!connection->isReadPaused() && !connection->isReceiving()) {
+                armUringRecv(*connection);
+            }
+        }
+    }
 
-    int epoll_ctl_result = epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_fd, nullptr);
-    if (epoll_ctl_result < 0) {
-        LOG_ERROR("Failed to remove client %d from epoll: %s", client_fd, strerror(errno));
+    flushUring(*connection);
+    if (refreshDeadline(*connection)) {
+        armUringTimeout(connection);
     }
-    close(client_fd);
-    LOG_INFO("Client %d removed", client_fd);
+    if (connection->state() == ConnectionState::CLOSING && !connection->isSending()) {
+        closeUring(client_fd);
+    }
+}
+
+void Server::handleUringPollOut(int client_fd) {
+    std::shared_ptr<Connection> connection = connections.find(client_fd);
+    if (!connection) {
+        return;
+    }
+    connection->setSending(false);
+    flushUring(*connection);
+    if (refreshDeadline(*connection)) {
+        armUringTimeout(connection);
+    }
+    if (connection->state() == ConnectionState::CLOSING && !connection->isSending()) {
+        closeUring(client_fd);
+    }
+}
+
+void Server::flushUring(Connection &connection) {
+    // 同一连接同时只有一个 send 在途，发送缓冲区在完成前保持有效
+    if (connection.isSending()) {
+        return;
+    }
+    if (!connection.prepareOutput()) {
+        LOG_ERROR("Response body producer failed for client %d", connection.fd());
+        abortUring(connection);
+        return;
+    }
+    // io_uring 没有 sendfile，文件块在循环线程上直接 sendfile（socket 非阻塞），写不动时挂一个 POLLOUT 再继续
+    while (connection.hasOutput() && connection.outputFileFd() >= 0) {
+        ssize_t sent = sendOutput(connection);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                connection.setSending(true);
+                ring->preparePollOut(connection.fd(), uringUserData(UringOp::POLL_OUT, connection.fd()));
+            } else {
+                LOG_ERROR("Send error to client %d: %s", connection.fd(), strerror(errno));
+                abortUring(connection);
+            }
+            return;
+        }
+        connection.consumeOutput(sent);
+        if (!connection.prepareOutput()) {
+            LOG_ERROR("Response body producer failed for client %d", connection.fd());
+            abortUring(connection);
+            return;
+        }
+    }
+    if (!connection.hasOutput()) {
+        return;
+    }
+    connection.setSending(true);
+    bool more;
+    const msghdr *msg = connection.gatherMessage(more);
+    ring->prepareSendMsg(connection.fd(), msg, uringUserData(UringOp::SEND, connection.fd()), more ? MSG_MORE : 0);
 }
 
-void Server::modifyEpollEvent(int fd, uint32_t events) {
-    epoll_event event;
-    event.data.fd = fd;
-    event.events = events | EPOLLET;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) < 0) {
-        LOG_ERROR("Failed to modify epoll event for fd %d: %s", fd, strerror(errno));
+void Server::closeUring(int client_fd) {
+    std::shared_ptr<Connection> connection = connections.find(client_fd);
+    if (!connection) {
+        return;
+    }
+    if (connection->isSending()) {
+        // 内核仍在使用发送缓冲区，等输出链发完后再关闭
+        connection->setState(ConnectionState::CLOSING);
+        return;
     }
+    connection->setState(ConnectionState::CLOSED);
+    ring->timers().cancel(connection->timerId());
+    connections.erase(client_fd);
+    LOG_INFO("Client %d removed", client_fd);
 }
 
 HttpResponse Server::generateResponse(const HttpRequest &request) {
-    auto [route, params] = router.matchRoute(request);
-    if (route) {
-        return route->getHandler()(request, params);
+    // 处理器可能运行在 Reactor 线程上，异常不能逃逸出事件循环
+    try {
+        auto [route, params] = router.matchRoute(request);
+        if (route) {
+            auto response = route->getHandler()(request, params);
+            if (compressor) {
+                compressor->compress(response, parseAcceptEncoding(request.getHeader("Accept-Encoding")));
+            }
+            return response;
+        }
+        // 如果没有匹配的路由，尝试提供静态文件
+        return staticFileController->serveFile(request, {});
+    } catch (const std::exception &e) {
+        LOG_ERROR("Handler failed for %s: %s", request.getPath().c_str(), e.what());
+        return HttpResponse::makeInternalServerErrorResponse();
+    }
+}
+
+ssize_t Server::sendOutput(Connection &connection) {
+    int file_fd = connection.outputFileFd();
+    if (file_fd < 0) {
+        // 连续的内存块（多个流水线响应的头部和响应体）一次 sendmsg 写出，响应体不再拼接拷贝
+        // 后面还有文件块时带 MSG_MORE，避免头部单独成包后等待延迟 ACK
+        iovec iov[Connection::MAX_IOVECS];
+        bool more;
+        msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = connection.gatherOutput(iov, Connection::MAX_IOVECS, more);
+        return sendmsg(connection.fd(), &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+    }
+    off_t offset = connection.outputFileOffset();
+    ssize_t sent = sendfile(connection.fd(), file_fd, &offset, connection.outputSize());
+    if (sent == 0) {
+        // 文件在发送过程中被截断，已发出的 Content-Length 无法兑现，只能断开
+        errno = EIO;
+        return -1;
+    }
+    return sent;
+}
+
+bool Server::negotiateKeepAlive(const HttpRequest &request, const HttpResponse &response, std::size_t count) const {
+    bool http11 = request.getVersion() == HttpVersion::HTTP_1_1;
+    // HTTP/1.1 默认持久，除非请求带 close；HTTP/1.0 只有显式请求 keep-alive 才保持
+    std::string option = request.getHeader("Connection");
+    bool keepAlive = http11 ? !hasConnectionOption(option, "close") : hasConnectionOption(option, "keep-alive");
+    if (keepAliveRequests > 0 && count >= keepAliveRequests) {
+        keepAlive = false;
+    }
+    // 处理函数要求关闭；HTTP/1.0 不支持 chunked，流式响应体以关闭连接结束
+    if (hasConnectionOption(response.getHeader("Connection"), "close") || (response.isStreaming() && !http11)) {
+        keepAlive = false;
+    }
+    return keepAlive;
+}
+
+std::string Server::keepAliveParameters(std::size_t count) const {
+    std::string parameters;
+    if (keepAliveTimeout.count() > 0) {
+        parameters = "timeout=" + std::to_string(keepAliveTimeout.count());
+    }
+    if (keepAliveRequests > 0) {
+        parameters += (parameters.empty() ? "max=" : ", max=") + std::to_string(keepAliveRequests - count);
+    }
+    return parameters;
+}
+
+bool Server::queueResponse(Connection &connection, const HttpRequest &request, HttpResponse response) {
+    std::size_t count = connection.countRequest();
+    bool keepAlive = negotiateKeepAlive(request, response, count);
+    // 只声明默认行为之外的情况：关闭连接，或回应客户端显式请求的 keep-alive 并告知空闲超时和剩余请求数
+    std::string option;
+    std::string parameters;
+    if (!keepAlive) {
+        option = "close";
+    } else if (hasConnectionOption(request.getHeader("Connection"), "keep-alive")) {
+        option = "keep-alive";
+        parameters = keepAliveParameters(count);
+    }
+
+    // HEAD 的头部与 GET 相同 (含 Content-Length)，但不能发送响应体，否则持久连接上的下一个响应会错位
+    bool head = request.getMethod() == HttpMethod::HEAD;
+    if (response.isSerialized()) {
+        auto bytes = response.takeSerialized();
+        std::size_t end = option.empty() && !head ? std::string::npos : bytes->find("\r\n\r\n");
+        if (end == std::string::npos) {
+            connection.appendOutput(std::move(bytes));
+            return !keepAlive;
+        }
+        // 预先序列化的响应是共享的，HEAD 只发送到头部结束的空行为止
+        std::size_t size = head ? end + 4 : bytes->size();
+        if (option.empty()) {
+            connection.appendOutput(std::move(bytes), 0, size);
+            return !keepAlive;
+        }
+        // 连接相关的头部作为单独的块插在头部结束的空行之前
+        std::string headers = "Connection: " + option + "\r\n";
+        if (!parameters.empty()) {
+            headers += "Keep-Alive: " + parameters + "\r\n";
+        }
+        connection.appendOutput(bytes, 0, end + 2);
+        connection.appendOutput(std::move(headers));
+        connection.appendOutput(std::move(bytes), end + 2, size - end - 2);
+        return !keepAlive;
+    }
+    if (!option.empty()) {
+        response.setHeader("Connection", option);
+    }
+    if (!parameters.empty()) {
+        response.setHeader("Keep-Alive", parameters);
+    }
+    if (head) {
+        // 响应体分段和生成器随 response 一起丢弃，打开的文件随之关闭
+        if (response.isStreaming() && request.getVersion() == HttpVersion::HTTP_1_1) {
+            response.setHeader("Transfer-Encoding", "chunked");
+        }
+        connection.appendOutput(response.serializeHeaders());
+        return !keepAlive;
+    }
+    if (response.hasBodyFile()) {
+        connection.appendOutput(response.serializeHeaders());
+        for (auto &segment : response.takeBodySegments()) {
+            if (segment.file.file) {
+                connection.appendFile(std::move(segment.file));
+            } else {
+                connection.appendOutput(std::move(segment.data));
+            }
+        }
+        return !keepAlive;
+    }
+    if (!response.isStreaming()) {
+        // 头部和响应体作为两个块进入输出链，发送时由 sendmsg 聚集
+        connection.appendOutput(response.serializeHeaders());
+        connection.appendOutput(response.takeBody());
+        return !keepAlive;
+    }
+    // HTTP/1.0 的流式响应体以关闭连接结束，上面已经协商为关闭
+    bool chunked = request.getVersion() == HttpVersion::HTTP_1_1;
+    if (chunked) {
+        response.setHeader("Transfer-Encoding", "chunked");
     }
-    // 如果没有匹配的路由，尝试提供静态文件
-    return staticFileController->serveFile(request, {});
+    connection.appendOutput(response.serializeHeaders());
+    connection.appendProducer(response.takeBodyProducer(), chunked);
+    return !keepAlive;
 }
 
+// Connection 和 Keep-Alive 由 queueResponse 按请求协商
 void Server::addCommonHeaders(HttpResponse &response) {
     response.setHeader("Server", "TinyWebServer/1.0");
     response.setHeader("Date", getCurrentDate());
-    response.setHeader("Connection", "close");
 }
 
 std::string Server::getCurrentDate() const {
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "server.h"
+#include "config_manager.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// 每个用例在临时目录中写一份配置和站点根目录，起一个真实的服务器，通过回环连接收发原始报文
+class ServerTest : public ::testing::Test {
+protected:
+    static constexpr const char* INDEX = "<h1>home</h1>";
+
+    void SetUp() override {
+        char dir[] = "/tmp/server_test_XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        base_ = dir;
+        fs::create_directories(base_ / "public");
+        std::ofstream(base_ / "public" / "index.html", std::ios::binary) << INDEX;
+        // 不同用例、不同进程错开端口，避免 TIME_WAIT 和并行运行的冲突
+        static int sequence = 0;
+        port_ = 20000 + (getpid() * 7 + sequence++) % 20000;
+    }
+
+    void TearDown() override {
+        if (server_) {
+            server_->stop();
+            thread_.join();
+            server_.reset();
+        }
+        fs::remove_all(base_);
+    }
+
+    void startServer(const std::string& options) {
+        fs::path configFile = base_ / "config.yaml";
+        std::ofstream(configFile) << "server:\n"
+                                  << "  port: " << port_ << "\n"
+                                  << "  thread_pool_size: 4\n"
+                                  << "  directory: " << (base_ / "public").string() << "\n"
+                                  << "  static_file_watch: false\n"
+                                  << options;
+        ASSERT_TRUE(ConfigManager::getInstance().loadConfig(configFile.string()));
+        std::string publicDirectory = (base_ / "public").string();
+        server_ = std::make_unique<Server>(port_, publicDirectory, 4);
+        thread_ = std::thread([this] {
+            server_->run();
+        });
+    }
+
+    // 在一个连接上发送全部请求，读到服务器关闭连接为止
+    std::string exchange(const std::string& requests) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        EXPECT_GE(fd, 0);
+        timeval timeout{5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port_);
+        EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+        EXPECT_EQ(send(fd, requests.data(), requests.size(), MSG_NOSIGNAL), static_cast<ssize_t>(requests.size()));
+        std::string response;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            response.append(buffer, n);
+        }
+        close(fd);
+        return response;
+    }
+
+    // 按请求方法把响应流切分成各个响应的头部：HEAD 的响应只有头部，其余按 Content-Length 跳过响应体
+    // 切分后必须正好用完整个响应流，多出的字节说明 HEAD 的响应体被发了出来
+    static std::vector<std::string> splitResponses(const std::string& stream, const std::vector<bool>& head) {
+        std::vector<std::string> headers;
+        std::size_t position = 0;
+        for (bool isHead : head) {
+            std::size_t end = stream.find("\r\n\r\n", position);
+            if (end == std::string::npos) {
+                ADD_FAILURE() << "missing response " << headers.size() << " in:\n" << stream;
+                return headers;
+            }
+            std::string block = stream.substr(position, end + 4 - position);
+            position = end + 4;
+            if (!isHead) {
+                std::size_t length = block.find("Content-Length: ");
+                if (length != std::string::npos) {
+                    position += std::stoul(block.substr(length + 16));
+                }
+            }
+            headers.push_back(std::move(block));
+        }
+        EXPECT_EQ(position, stream.size()) << stream;
+        return headers;
+    }
+
+    fs::path base_;
+    int port_ = 0;
+    std::unique_ptr<Server> server_;
+    std::thread thread_;
+};
+
+TEST_F(ServerTest, HeadResponseCarriesNoBody) {
+    startServer("");
+    std::string stream = exchange("HEAD /index.html HTTP/1.1\r\nHost: test\r\n\r\n"
+                                  "GET /missing HTTP/1.1\r\nHost: test\r\nConnection: close\r\n\r\n");
+    auto headers = splitResponses(stream, {true, false});
+    ASSERT_EQ(headers.size(), 2u);
+    EXPECT_EQ(headers[0].rfind("HTTP/1.1 200", 0), 0u);
+    EXPECT_NE(headers[0].find("Content-Length: 13\r\n"), std::string::npos);
+    // 第二个状态行紧跟在第一个响应的头部之后
+    EXPECT_EQ(stream.compare(headers[0].size(), 12, "HTTP/1.1 404"), 0);
+}
+
+TEST_F(ServerTest, HeadHitsContentCacheWithoutBody) {
+    // 第一次 GET 之后进入内容缓存，后面的 HEAD 命中预先序列化的完整响应
+    startServer("  content_cache_min_uses: 1\n");
+    std::string stream = exchange("GET /index.html HTTP/1.1\r\nHost: test\r\n\r\n"
+                                  "HEAD /index.html HTTP/1.1\r\nHost: test\r\n\r\n"
+                                  "HEAD /index.html HTTP/1.1\r\nHost: test\r\nConnection: close\r\n\r\n");
+    auto headers = splitResponses(stream, {false, true, true});
+    ASSERT_EQ(headers.size(), 3u);
+    EXPECT_NE(stream.find(INDEX), std::string::npos);
+    for (const auto& block : headers) {
+        EXPECT_EQ(block.rfind("HTTP/1.1 200", 0), 0u);
+        EXPECT_NE(block.find("Content-Length: 13\r\n"), std::string::npos);
+    }
+    EXPECT_NE(headers[2].find("Connection: close\r\n"), std::string::npos);
+}
+
+TEST_F(ServerTest, PipelinedHeadCarriesNoBody) {
+    startServer("  pipeline_depth: 4\n");
+    std::string stream = exchange("HEAD /index.html HTTP/1.1\r\nHost: test\r\n\r\n"
+                                  "GET /index.html HTTP/1.1\r\nHost: test\r\n\r\n"
+                                  "HEAD /index.html HTTP/1.1\r\nHost: test\r\n\r\n"
+                                  "HEAD /missing HTTP/1.1\r\nHost: test\r\n\r\n"
+                                  "GET /index.html HTTP/1.1\r\nHost: test\r\nConnection: close\r\n\r\n");
+    auto headers = splitResponses(stream, {true, false, true, true, false});
+    ASSERT_EQ(headers.size(), 5u);
+    const char* statuses[] = {"HTTP/1.1 200", "HTTP/1.1 200", "HTTP/1.1 200", "HTTP/1.1 404", "HTTP/1.1 200"};
+    for (std::size_t i = 0; i < headers.size(); i++) {
+        EXPECT_EQ(headers[i].rfind(statuses[i], 0), 0u) << headers[i];
+    }
+}
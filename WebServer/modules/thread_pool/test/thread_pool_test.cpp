@@ -3,6 +3,7 @@
 #include "thread_pool.h"
 #include <atomic>
 #include <chrono>
+#include <iostream>
 #include <numeric>
 
 class ThreadPoolTest : public ::testing::Test {
@@ -21,7 +22,7 @@ protected:
 TEST_F(ThreadPoolTest, TaskExecution) {
     std::atomic<int> counter(0);
 
-    cout << "star:" << endl;
+    std::cout << "star:" << std::endl;
     for (int i = 0; i < 100; ++i) {
         pool->enqueue([&counter]() {
             counter++;
@@ -0,0 +1,66 @@
+// timing_wheel.h
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// 哈希时间轮：定时器按到期的 tick 数散列到槽位，每个 tick 转过一个槽位，插入和取消都是 O(1)
+// 超过一圈的定时器记下剩余圈数，指针转到该槽位时减一；精度为一个 tick，到期时间向上取整到 tick
+// 不加锁，只在所属事件循环线程中使用；时间只由 advance() 推进
+class TimingWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = uint64_t;  // 0 不是有效的定时器
+
+    static constexpr Clock::duration DEFAULT_TICK = std::chrono::milliseconds(100);
+    static constexpr std::size_t DEFAULT_SLOTS = 512;
+
+    explicit TimingWheel(Clock::duration tick = DEFAULT_TICK, std::size_t slots = DEFAULT_SLOTS,
+                         Clock::time_point now = Clock::now());
+
+    // 禁用拷贝
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // delay 不足一个 tick 的按一个 tick 算
+    TimerId add(Clock::duration delay, Callback callback);
+    // 已到期或不存在时返回 false
+    bool cancel(TimerId id);
+    // 按 tick 转到 now，依次执行到期的定时器并返回执行的个数；回调中可以添加或取消定时器
+    std::size_t advance(Clock::time_point now);
+
+    std::size_t size() const;
+    bool empty() const;
+    Clock::duration tick() const;
+    // 距离下一次转动的毫秒数，作为 epoll_wait 的超时；没有定时器时返回 -1
+    int timeoutMillis(Clock::time_point now) const;
+
+private:
+    struct Timer {
+        TimerId id;
+        std::size_t rounds;  // 指针还要经过该槽位多少次才到期
+        Callback callback;
+    };
+    struct Location {
+        std::size_t slot;  // 等于槽位数时表示在 expired_ 中等待执行
+        std::list<Timer>::iterator timer;
+    };
+
+    Clock::duration tick_;
+    std::vector<std::list<Timer>> slots_;
+    std::list<Timer> expired_;
+    std::unordered_map<TimerId, Location> index_;
+    std::size_t current_;
+    Clock::time_point next_tick_;
+    TimerId next_id_;
+
+    std::list<Timer>& listAt(std::size_t slot);
+    // 转过一个槽位，把到期的定时器移到 expired_
+    void step();
+};
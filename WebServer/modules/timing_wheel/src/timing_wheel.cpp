@@ -0,0 +1,104 @@
+// timing_wheel.cpp
+#include "timing_wheel.h"
+#include <iterator>
+#include <stdexcept>
+
+TimingWheel::TimingWheel(Clock::duration tick, std::size_t slots, Clock::time_point now)
+    : tick_(tick),
+      slots_(slots),
+      current_(0),
+      next_tick_(now + tick),
+      next_id_(1) {
+    if (tick <= Clock::duration::zero() || slots == 0) {
+        throw std::invalid_argument("TimingWheel needs a positive tick and at least one slot");
+    }
+}
+
+TimingWheel::TimerId TimingWheel::add(Clock::duration delay, Callback callback) {
+    std::size_t ticks = 1;
+    if (delay > tick_) {
+        ticks = static_cast<std::size_t>((delay + tick_ - Clock::duration(1)) / tick_);
+    }
+    std::size_t slot = (current_ + ticks) % slots_.size();
+    TimerId id = next_id_++;
+    auto& list = slots_[slot];
+    list.push_back(Timer{id, (ticks - 1) / slots_.size(), std::move(callback)});
+    index_.emplace(id, Location{slot, std::prev(list.end())});
+    return id;
+}
+
+bool TimingWheel::cancel(TimerId id) {
+    auto it = index_.find(id);
+    if (it == index_.end()) {
+        return false;
+    }
+    listAt(it->second.slot).erase(it->second.timer);
+    index_.erase(it);
+    return true;
+}
+
+std::size_t TimingWheel::advance(Clock::time_point now) {
+    if (index_.empty()) {
+        // 没有定时器时不空转，直接把下一次转动对齐到当前时间之后
+        if (now >= next_tick_) {
+            next_tick_ = now + tick_;
+        }
+        return 0;
+    }
+    while (now >= next_tick_) {
+        step();
+        next_tick_ += tick_;
+    }
+    std::size_t fired = 0;
+    while (!expired_.empty()) {
+        // 先摘下再执行，回调中取消的只会是还没执行的定时器
+        Timer timer = std::move(expired_.front());
+        expired_.pop_front();
+        index_.erase(timer.id);
+        timer.callback();
+        fired++;
+    }
+    return fired;
+}
+
+std::size_t TimingWheel::size() const {
+    return index_.size();
+}
+
+bool TimingWheel::empty() const {
+    return index_.empty();
+}
+
+TimingWheel::Clock::duration TimingWheel::tick() const {
+    return tick_;
+}
+
+int TimingWheel::timeoutMillis(Clock::time_point now) const {
+    if (index_.empty()) {
+        return -1;
+    }
+    if (!expired_.empty() || now >= next_tick_) {
+        return 0;
+    }
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(next_tick_ - now);
+    return static_cast<int>(wait.count());
+}
+
+std::list<TimingWheel::Timer>& TimingWheel::listAt(std::size_t slot) {
+    return slot == slots_.size() ? expired_ : slots_[slot];
+}
+
+void TimingWheel::step() {
+    current_ = (current_ + 1) % slots_.size();
+    auto& list = slots_[current_];
+    for (auto it = list.begin(); it != list.end();) {
+        auto next = std::next(it);
+        if (it->rounds > 0) {
+            it->rounds--;
+        } else {
+            index_[it->id].slot = slots_.size();
+            expired_.splice(expired_.end(), list, it);
+        }
+        it = next;
+    }
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "timing_wheel.h"
+#include <vector>
+
+using namespace std::chrono_literals;
+using Clock = TimingWheel::Clock;
+
+class TimingWheelTest : public ::testing::Test {
+protected:
+    Clock::time_point start = Clock::now();
+    TimingWheel wheel{10ms, 8, start};
+};
+
+TEST_F(TimingWheelTest, FiresAfterDelayRoundedUpToTick) {
+    int fired = 0;
+    wheel.add(25ms, [&] { fired++; });
+    EXPECT_EQ(wheel.advance(start + 20ms), 0u);
+    EXPECT_EQ(fired, 0);
+    EXPECT_EQ(wheel.advance(start + 30ms), 1u);
+    EXPECT_EQ(fired, 1);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST_F(TimingWheelTest, DelaysLongerThanOneRevolution) {
+    // 8 个槽位一圈 80ms，200ms 要转过同一槽位两次
+    std::vector<int> order;
+    wheel.add(200ms, [&] { order.push_back(200); });
+    wheel.add(40ms, [&] { order.push_back(40); });
+    wheel.add(120ms, [&] { order.push_back(120); });
+    wheel.advance(start + 190ms);
+    EXPECT_EQ(order, (std::vector<int>{40, 120}));
+    wheel.advance(start + 200ms);
+    EXPECT_EQ(order, (std::vector<int>{40, 120, 200}));
+}
+
+TEST_F(TimingWheelTest, CancelRemovesPendingTimer) {
+    int fired = 0;
+    auto id = wheel.add(30ms, [&] { fired++; });
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_TRUE(wheel.cancel(id));
+    EXPECT_FALSE(wheel.cancel(id));
+    wheel.advance(start + 100ms);
+    EXPECT_EQ(fired, 0);
+}
+
+TEST_F(TimingWheelTest, CallbacksCanCancelAndRearm) {
+    int first = 0;
+    int second = 0;
+    TimingWheel::TimerId other = 0;
+    // 同一 tick 到期的两个定时器，先执行的取消后一个并重新挂上自己
+    wheel.add(10ms, [&] {
+        first++;
+        EXPECT_TRUE(wheel.cancel(other));
+        wheel.add(10ms, [&] { first++; });
+    });
+    other = wheel.add(10ms, [&] { second++; });
+    EXPECT_EQ(wheel.advance(start + 10ms), 1u);
+    EXPECT_EQ(second, 0);
+    EXPECT_EQ(wheel.size(), 1u);
+    wheel.advance(start + 20ms);
+    EXPECT_EQ(first, 2);
+}
+
+TEST_F(TimingWheelTest, TimeoutMillisTracksNextTick) {
+    EXPECT_EQ(wheel.timeoutMillis(start), -1);
+    wheel.add(50ms, [] {});
+    EXPECT_EQ(wheel.timeoutMillis(start + 3ms), 7);
+    EXPECT_EQ(wheel.timeoutMillis(start + 10ms), 0);
+}
+
+TEST_F(TimingWheelTest, IdleWheelDoesNotReplayElapsedTicks) {
+    // 空闲期间经过的时间不计入之后添加的定时器
+    wheel.advance(start + 1s);
+    int fired = 0;
+    wheel.add(20ms, [&] { fired++; });
+    wheel.advance(start + 1s + 15ms);
+    EXPECT_EQ(fired, 0);
+    wheel.advance(start + 1s + 30ms);
+    EXPECT_EQ(fired, 1);
+}